@@ -4,18 +4,30 @@
 #include <Arduino.h>
 #include <WiFi.h>  // Include the correct WiFi library for your hardware
 #include <ArduinoHttpClient.h>
-#include <ArduinoJson.h>
 #include <SPIFFS.h>
 #include <Base64.h>
 #include "Door.h"
-#include <unordered_set>
 #include "ExponentialBackoffHandler.h"
+#include "ContactsSync.h"
+#include "HttpClientTransport.h"
+#include "MemberDirectory.h"
+#include "PagePipeline.h"
 
 
 /**
  * @brief The `Auth` class handles WildApricot requests, authenticated tag caching, and tag authorization.
  */
 class Auth {
+public:
+    /**
+     * @brief Outcome of a cache refresh, used to drive the refresh scheduler.
+     */
+    enum class SyncResult {
+        Changed,   ///< The tag set was fetched and differs from the cache.
+        Unchanged, ///< The tag set was fetched and matches the cache; contact IDs and names may have been updated.
+        Failed     ///< The fetch or parse failed; the cache was left untouched.
+    };
+
 private:
     static Auth* instance; ///< Singleton instance of the Auth class.
     static const char* apiEndpoint; ///< API endpoint for tag data retrieval.
@@ -23,10 +35,19 @@ private:
     static const char* cacheFilePath; ///< File path for caching tag data.
     static const char* apiKey; ///< API key for authentication.
     static const int serverPort; ///< Port number for the server.
-    std::unordered_set<uint32_t> cachedTagIDs; ///< Cached RFID tag IDs.
+    static const uint32_t responseTimeoutMs; ///< Maximum time to wait for an HTTP response.
+    static const size_t pageBufferSize; ///< Size of each page buffer in bytes.
+    static const uint32_t contactsPageSize; ///< Contacts requested per page, sized so a page fits in pageBufferSize.
+    static const size_t pagePoolSize; ///< Number of page buffers shared by the sync pipeline.
+    static const bool pipelinedSync; ///< Parse pages on a separate task while the next one downloads (AUTH_SERIAL_SYNC disables).
+    MemberDirectory members; ///< Cached authorized tags and their members.
+    SemaphoreHandle_t cacheMutex; ///< Guards members between the RFID task and the refresh.
     static const char* serverName; ///< Server name for API requests.
     WiFiClient& wifiClient; ///< Reference to the WiFi client.
     HttpClient httpClient; ///< HTTP client for API requests.
+    HttpClientTransport transport; ///< The sync's requests, sent through httpClient.
+    String tokenAuthorization; ///< Authorization header of token requests, from the API key.
+    ContactsSync contactsSync; ///< Token, count and page requests of a sync.
     ExponentialBackoffHandler backoffHandler; ///< Backoff handler for failed attempts.
 
     /**
@@ -36,10 +57,8 @@ private:
     Auth(WiFiClient& client);
 
     void initWifi(); ///< Initialize WiFi connection.
-    String getAuthToken(); ///< Get the authentication token.
-    std::unordered_set<uint32_t> getTagIds(const String& authToken); ///< Get RFID tag IDs.
-    String fetchRFIDJson(const String& authToken); ///< Fetch RFID data from the server.
-    void parseAndCacheRFIDData(const String& jsonData); ///< Parse and cache RFID Json data.
+    ContactsSync::Config syncConfig() const; ///< Endpoint and paging parameters of contactsSync.
+    SyncResult cacheMembers(MemberDirectory&& directory); ///< Replace the cache if the members changed, persist it if the tags did.
 
 public:
     /**
@@ -68,7 +87,12 @@ public:
      * @return True if the tag is authorized, false otherwise.
      */
     bool isTagAuthorized(const uint32_t& tagId);
-    void fetchAndCacheRFIDData();
+
+    /**
+     * @brief Fetch the tag list from WildApricot and replace the cache if it parsed successfully.
+     * @return Whether the cache changed, stayed the same, or the refresh failed.
+     */
+    SyncResult fetchAndCacheRFIDData();
 
     Auth(const Auth&) = delete; ///< Disable copy constructor.
     Auth& operator=(const Auth&) = delete; ///< Disable assignment operator.
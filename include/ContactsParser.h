@@ -0,0 +1,94 @@
+#ifndef CONTACTS_PARSER_H
+#define CONTACTS_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include "MemberDirectory.h"
+
+// Size of each buffer a Contacts page is downloaded into, in bytes
+#ifndef CONTACTS_PAGE_BUFFER_SIZE
+#define CONTACTS_PAGE_BUFFER_SIZE 24576
+#endif
+
+/**
+ * @brief Parses WildApricot token and Contacts responses; contacts go into a MemberDirectory::Builder.
+ *
+ * Free of Arduino and network dependencies (only ArduinoJson), so the same parsing code runs on the
+ * device and in the native test build against the WildApricot replay server.
+ */
+class ContactsParser {
+public:
+    /**
+     * Result of parsing a response.
+     */
+    enum class Result {
+        Ok,              ///< Response parsed.
+        InvalidJson,     ///< Body is not valid JSON, e.g. because it was truncated.
+        NoMemory,        ///< The JSON document did not fit in its buffer.
+        MissingContacts, ///< Valid JSON without a Contacts array.
+        MissingCount,    ///< Valid JSON without a numeric Count.
+        MissingToken,    ///< Valid JSON without an access_token string, or one too long for its buffer.
+        TooManyMembers   ///< More members than the builder expected, or it could not grow its staging.
+    };
+
+    /**
+     * Query parameter limiting Contacts records to system fields plus Id, DisplayName and the RFID field,
+     * with its leading '&'. Without it every custom field value is returned and a record grows several-fold.
+     */
+    static const char* const selectQuery;
+
+    static constexpr size_t maxContactBytes = 1024; ///< Budget for one $select-ed contact record.
+    static constexpr size_t pageEnvelopeBytes = 64; ///< Budget for the `{"Contacts":[...]}` wrapper and terminator.
+
+    /**
+     * Number of $select-ed contacts to request per page so the page fits in a buffer.
+     *
+     * @param bufferSize Size of the page buffer in bytes.
+     * @return Contacts per page, at least 1.
+     */
+    static constexpr uint32_t contactsPerPage(size_t bufferSize) {
+        return bufferSize > pageEnvelopeBytes + maxContactBytes
+                   ? static_cast<uint32_t>((bufferSize - pageEnvelopeBytes) / maxContactBytes)
+                   : 1;
+    }
+
+    /**
+     * Adds every contact of a Contacts page (`{"Contacts": [...]}`) to the builder.
+     * Only Id, DisplayName and the RFID field are read.
+     *
+     * @param json Response body. Does not need to be NUL terminated.
+     * @param length Length of the body in bytes.
+     * @param builder Builder receiving the members.
+     * @return Parse result; the builder may hold part of the page if this is not Result::Ok.
+     */
+    static Result parseContacts(const char* json, size_t length, MemberDirectory::Builder& builder);
+
+    /**
+     * Reads the contact count of a `$count=true` response (`{"Count": n}`).
+     *
+     * @param json Response body. Does not need to be NUL terminated.
+     * @param length Length of the body in bytes.
+     * @param contactCount Receives the count.
+     * @return Parse result.
+     */
+    static Result parseCount(const char* json, size_t length, uint32_t& contactCount);
+
+    /**
+     * Reads the access token of a token response (`{"access_token": "..."}`).
+     *
+     * @param json Response body. Does not need to be NUL terminated.
+     * @param length Length of the body in bytes.
+     * @param token Receives the NUL terminated token.
+     * @param tokenSize Size of token in bytes.
+     * @return Parse result.
+     */
+    static Result parseToken(const char* json, size_t length, char* token, size_t tokenSize);
+
+    /**
+     * @param result A parse result.
+     * @return Short description for logging.
+     */
+    static const char* describe(Result result);
+};
+
+#endif // CONTACTS_PARSER_H
@@ -0,0 +1,102 @@
+#ifndef CONTACTS_SYNC_H
+#define CONTACTS_SYNC_H
+
+#include <cstddef>
+#include <cstdint>
+#include "ContactsParser.h"
+#include "MemberDirectory.h"
+#include "PageSink.h"
+#include "SyncTransport.h"
+
+/**
+ * @brief Downloads the WildApricot membership into a MemberDirectory.
+ *
+ * Requests a token, the contact count and then `$top`/`$skip` pages of Contacts, which are read into
+ * page buffers and parsed into a MemberDirectory::Builder. A 401 retries the whole sequence once with
+ * a new token. Any failed request, truncated or oversized body, parse error or allocation failure
+ * fails the sync and leaves the caller's directory untouched.
+ *
+ * Free of Arduino dependencies: requests go through a SyncTransport, pages through a PageSink, and
+ * logging and the free-heap probe are plain function pointers. Auth runs it on the device and the
+ * native tests run the same code against the WildApricot replay server.
+ */
+class ContactsSync {
+public:
+    using Logger = void (*)(const char* message);  ///< Receives one log line, without newline.
+    using FreeBlockProbe = size_t (*)();           ///< Returns the largest allocatable block in bytes.
+
+    /**
+     * Endpoint and paging parameters.
+     */
+    struct Config {
+        const char* tokenPath = "/auth/token";     ///< Token endpoint path.
+        const char* tokenAuthorization = "";       ///< Authorization header of token requests ("Basic ...").
+        const char* contactsPath = "";             ///< Contacts endpoint path, without query string.
+        uint32_t pageSize = ContactsParser::contactsPerPage(CONTACTS_PAGE_BUFFER_SIZE); ///< Contacts per page.
+        bool selectFields = true;                  ///< Append ContactsParser::selectQuery to page requests.
+        size_t maxNameLength = MEMBER_NAME_MAX_LENGTH; ///< Longest display name kept; 0 keeps contact IDs only.
+    };
+
+    /**
+     * Counters of the last sync, the 401 retry included.
+     */
+    struct Stats {
+        int httpCode = 0;          ///< Status of the last request, negative on connection errors.
+        uint32_t requests = 0;     ///< HTTP requests made, token requests included.
+        uint32_t contactCount = 0; ///< Contact count reported by WildApricot.
+        uint32_t pages = 0;        ///< Contacts pages downloaded.
+        uint64_t bodyBytes = 0;    ///< Response body bytes received.
+    };
+
+    /**
+     * Constructor for ContactsSync.
+     *
+     * @param transport HTTP transport to the WildApricot API.
+     * @param config Endpoint and paging parameters. The strings must outlive the sync.
+     * @param logger Log output.
+     * @param largestFreeBlock Probe used to check the directory fits before it is allocated.
+     */
+    ContactsSync(SyncTransport& transport, const Config& config, Logger logger, FreeBlockProbe largestFreeBlock);
+    ContactsSync(const ContactsSync&) = delete; ///< Disable copy constructor.
+    ContactsSync& operator=(const ContactsSync&) = delete; ///< Disable assignment operator.
+
+    /**
+     * Runs one sync.
+     *
+     * @param pages Where downloaded pages are parsed, e.g. a SerialPageSink or a PagePipeline.
+     * @param directory Receives the new directory; left untouched if the sync fails.
+     * @return True if every page was downloaded and parsed and the directory was built.
+     */
+    bool sync(PageSink& pages, MemberDirectory& directory);
+
+    /**
+     * @return Counters of the last sync.
+     */
+    const Stats& getStats() const;
+
+private:
+    static constexpr size_t maxTokenLength = 256;   ///< Longest access token accepted.
+    static constexpr size_t tokenBodySize = 1024;   ///< Buffer for the token response.
+    static constexpr size_t countBodySize = 128;    ///< Buffer for the contact count response.
+    static constexpr size_t maxPathLength = 256;    ///< Longest request path including the query string.
+
+    SyncTransport& transport;          ///< HTTP transport.
+    Config config;                     ///< Endpoint and paging parameters.
+    Logger logger;                     ///< Log output.
+    FreeBlockProbe largestFreeBlock;   ///< Free heap probe.
+    MemberDirectory::Builder stagingMembers; ///< Members collected by the parser during a sync.
+    char authorization[8 + maxTokenLength] = ""; ///< "Bearer <token>" of the current token.
+    Stats stats;                       ///< Counters of the current sync.
+
+    bool fetchAuthToken(); ///< Request a new token into authorization.
+    bool fetchContactCount(uint32_t& contactCount); ///< Fetch the number of contacts.
+    bool fetchContactsPage(uint32_t skip, PageBuffer& page); ///< Download one page of contacts.
+    bool readBody(PageBuffer& page); ///< Read a response body into a buffer and check it is complete.
+    bool downloadPages(PageSink& pages, uint32_t contactCount); ///< Download every page into the sink.
+    bool downloadMembers(PageSink& pages, MemberDirectory& directory); ///< Download every page and build the directory.
+    static bool parsePage(PageBuffer& page, void* context); ///< Parse one page into stagingMembers.
+    void logRequestFailure(const char* what, int httpCode); ///< Log a failed request with its status.
+    void logLine(const char* format, ...); ///< Format and log one line.
+};
+
+#endif // CONTACTS_SYNC_H
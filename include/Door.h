@@ -15,6 +15,7 @@ private:
     static constexpr unsigned long relayUnlockDuration = 6000; ///< Duration for door unlock relay activation.
     unsigned long lastUnlockTime = 0; ///< Timestamp of the last door unlock.
     bool isDoorLocked = true; ///< Flag indicating whether the door is locked.
+    SemaphoreHandle_t stateMutex; ///< Guards the lock state between pollRFIDTask (unlock) and doorTask (relock).
 
     /**
      * @brief Private constructor for the Door class.
@@ -33,6 +34,11 @@ private:
      */
     void turnOffLight(int pin);
 
+    /**
+     * @brief Drive the lock and lights to locked. The caller holds stateMutex.
+     */
+    void relock();
+
 public:
     /**
      * @brief Get the singleton instance of the Door class.
@@ -51,7 +57,10 @@ public:
     void unlock();
 
     /**
-     * @brief Update the state of the door and indicator lights.
+     * @brief Relock the door once the unlock duration has passed.
+     *
+     * This is the only thing that ends an unlock, so it must run every few hundred milliseconds
+     * regardless of cache refreshes; main.cpp calls it from doorTask.
      */
     void update();
 
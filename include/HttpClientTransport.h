@@ -0,0 +1,32 @@
+#ifndef HTTP_CLIENT_TRANSPORT_H
+#define HTTP_CLIENT_TRANSPORT_H
+
+#include <Arduino.h>
+#include <ArduinoHttpClient.h>
+#include "SyncTransport.h"
+
+/**
+ * @brief SyncTransport on ArduinoHttpClient, used by Auth to reach WildApricot from the device.
+ */
+class HttpClientTransport : public SyncTransport {
+public:
+    /**
+     * Constructor for HttpClientTransport.
+     *
+     * @param client HTTP client connected to the WildApricot API host.
+     * @param responseTimeoutMs Maximum time to wait for a response or for more body data.
+     */
+    HttpClientTransport(HttpClient& client, uint32_t responseTimeoutMs);
+
+    int request(const char* method, const char* path, const char* authorization,
+                const char* contentType, const char* body) override;
+    int contentLength() override;
+    int read(char* buffer, size_t size) override;
+    void stop() override;
+
+private:
+    HttpClient& client;                ///< HTTP client for API requests.
+    const uint32_t responseTimeoutMs;  ///< Maximum time to wait for body data.
+};
+
+#endif // HTTP_CLIENT_TRANSPORT_H
@@ -0,0 +1,207 @@
+#ifndef MEMBER_DIRECTORY_H
+#define MEMBER_DIRECTORY_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Longest display name kept per member, in bytes; 0 (the default) keeps contact IDs only
+#ifndef MEMBER_NAME_MAX_LENGTH
+#define MEMBER_NAME_MAX_LENGTH 0
+#endif
+
+/**
+ * @brief Authorized tags and the members they belong to, stored in a single arena allocation.
+ *
+ * The arena holds columns aligned by index, followed by the interned display names if names are kept:
+ *
+ *     [tagIds: uint32_t x n][contactIds: uint32_t x n]([nameOffsets: uint32_t x n][names: char x m])
+ *
+ * Tag IDs are sorted, so a swipe is a binary search over the tag column only; the contact ID and name
+ * of the matching index are read afterwards, for the audit log. Identical names are stored once.
+ * A directory is built once per refresh by MemberDirectory::Builder and released as a unit.
+ */
+class MemberDirectory {
+public:
+    static constexpr size_t npos = SIZE_MAX; ///< Returned by find() for unknown tags.
+
+    /**
+     * @brief Collects members during a sync and packs them into a MemberDirectory.
+     *
+     * Only tagged members are staged, so staging grows with the members that end up in the directory
+     * rather than with the contact count: the columns live in one block that grows by a quarter when
+     * full. Names go into a pool that grows by half, with a hash slot table (freed before build())
+     * to find names that are already stored. build() sorts the columns in place and shrinks the
+     * block into the directory's arena, so the old directory, the staging and the new directory are
+     * never all allocated at once. A failed allocation fails add() instead of aborting.
+     */
+    class Builder {
+    public:
+        /**
+         * Constructor for Builder. Allocates nothing until members are added.
+         *
+         * @param maxNameLength Longest display name kept, in bytes; 0 keeps contact IDs only.
+         */
+        explicit Builder(size_t maxNameLength = MEMBER_NAME_MAX_LENGTH);
+        ~Builder();
+        Builder(const Builder&) = delete; ///< Disable copy constructor.
+        Builder& operator=(const Builder&) = delete; ///< Disable assignment operator.
+
+        /**
+         * Discards anything staged and starts a new set of members. Allocates nothing.
+         *
+         * @param expectedMembers Upper bound on tagged members, e.g. the contact count. A little
+         *        slack is allowed for contacts added while the sync runs.
+         */
+        void begin(size_t expectedMembers);
+
+        /**
+         * Adds a member. Tags of 0 are ignored; if a tag appears twice the lowest contact ID wins.
+         * If the name pool cannot grow the member is kept without its name.
+         *
+         * @param tagId RFID tag ID.
+         * @param contactId WildApricot contact ID.
+         * @param displayName Display name, truncated to the maximum name length. May be null.
+         * @return False if more members were added than expected, or staging could not grow.
+         */
+        bool add(uint32_t tagId, uint32_t contactId, const char* displayName);
+
+        /**
+         * @return True if display names are kept.
+         */
+        bool keepsNames() const;
+
+        /**
+         * @return True if add() failed because staging could not grow.
+         */
+        bool isOutOfMemory() const;
+
+        /**
+         * @return Largest new block build() may need, 0 if the arena fits in the staging block.
+         *         To check against the largest free heap block first.
+         */
+        size_t getBuildBytes() const;
+
+        /**
+         * @return Staging memory currently allocated, in bytes.
+         */
+        size_t getStagingBytes() const;
+
+        /**
+         * @return Names left out because the name pool could not grow.
+         */
+        size_t getDroppedNames() const;
+
+        /**
+         * Sorts the staged members in place and turns the staging block into the directory's arena.
+         * Any other staging memory is freed.
+         *
+         * @param directory Receives the new directory; left untouched if the arena cannot be sized.
+         * @return False if the arena could not be allocated; staging is discarded either way.
+         */
+        bool build(MemberDirectory& directory);
+
+        /**
+         * Discards the staged members and frees the staging memory.
+         */
+        void clear();
+
+    private:
+        static constexpr size_t firstChunkMembers = 256; ///< Members in the first staging block.
+        static constexpr size_t firstNamesBytes = 1024;  ///< Bytes in the first name pool.
+        static constexpr size_t firstSlotCount = 64;     ///< Slots in the first name table.
+
+        const size_t maxNameLength;      ///< Longest display name kept; 0 keeps none.
+        const size_t columnCount;        ///< Columns per member: tag, contact ID and, with names, name offset.
+        uint32_t* columns = nullptr;     ///< Staging block: each column holds memberCapacity entries.
+        size_t memberCount = 0;          ///< Members staged.
+        size_t memberCapacity = 0;       ///< Members the staging block has room for.
+        size_t memberLimit = 0;          ///< Most members begin() allows.
+        char* names = nullptr;           ///< Interned names, NUL separated; offset 0 is the empty name.
+        size_t namesLength = 0;          ///< Bytes used in names.
+        size_t namesCapacity = 0;        ///< Bytes allocated for names.
+        uint32_t* nameSlots = nullptr;   ///< Open-addressing table of name offsets; 0 marks an empty slot.
+        size_t slotCount = 0;            ///< Slots in nameSlots, a power of two.
+        size_t nameCount = 0;            ///< Distinct names stored.
+        size_t droppedNames = 0;         ///< Names left out because the pool could not grow.
+        bool outOfMemory = false;        ///< Set when the staging block could not grow.
+
+        uint32_t* column(size_t index) const; ///< Start of a staging column.
+        bool growMembers();
+        uint32_t internName(const char* displayName);
+        bool growNames(size_t needed);
+        bool growSlots();
+        bool memberLess(size_t a, size_t b) const;
+        void swapMembers(size_t a, size_t b);
+        void siftDown(size_t root, size_t end);
+        void sortMembers();
+        size_t arenaBytesFor(size_t count) const;
+    };
+
+    MemberDirectory() = default;
+    ~MemberDirectory();
+    MemberDirectory(MemberDirectory&& other) noexcept;
+    MemberDirectory& operator=(MemberDirectory&& other) noexcept;
+    MemberDirectory(const MemberDirectory&) = delete; ///< Disable copy constructor.
+    MemberDirectory& operator=(const MemberDirectory&) = delete; ///< Disable assignment operator.
+
+    /**
+     * Looks up a tag. Only touches the tag column.
+     *
+     * @param tagId RFID tag ID.
+     * @return Index of the member, or npos if the tag is not authorized.
+     */
+    size_t find(uint32_t tagId) const;
+
+    /**
+     * @param index Index returned by find().
+     * @return WildApricot contact ID of the member.
+     */
+    uint32_t getContactId(size_t index) const;
+
+    /**
+     * @param index Index returned by find().
+     * @return Display name of the member, empty if unknown.
+     */
+    const char* getDisplayName(size_t index) const;
+
+    /**
+     * @param index Index between 0 and size().
+     * @return Tag ID at that index, in ascending order.
+     */
+    uint32_t getTagId(size_t index) const;
+
+    /**
+     * @return Number of members (unique tags).
+     */
+    size_t size() const;
+
+    /**
+     * @return Size of the arena allocation in bytes.
+     */
+    size_t getArenaBytes() const;
+
+    /**
+     * @param other Directory to compare with.
+     * @return True if both hold the same tags, contact IDs and names.
+     */
+    bool sameMembers(const MemberDirectory& other) const;
+
+    /**
+     * Compares the tag columns only, which is all the flash cache stores.
+     *
+     * @param other Directory to compare with.
+     * @return True if both authorize the same tags.
+     */
+    bool sameTags(const MemberDirectory& other) const;
+
+private:
+    uint8_t* arena = nullptr;         ///< Single allocation holding every column and the names.
+    size_t arenaBytes = 0;            ///< Size of the arena in bytes.
+    size_t count = 0;                 ///< Number of members.
+    const uint32_t* tagIds = nullptr;      ///< Sorted tag column.
+    const uint32_t* contactIds = nullptr;  ///< Contact ID column.
+    const uint32_t* nameOffsets = nullptr; ///< Offsets into names; null if names are not kept.
+    const char* names = nullptr;           ///< Interned names; null if names are not kept.
+};
+
+#endif // MEMBER_DIRECTORY_H
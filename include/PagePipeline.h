@@ -0,0 +1,93 @@
+#ifndef PAGE_PIPELINE_H
+#define PAGE_PIPELINE_H
+
+#include <Arduino.h>
+#include "PageSink.h"
+
+/**
+ * @brief Two-stage producer/consumer pipeline for paginated downloads.
+ *
+ * The network stage (the caller) fills recycled page buffers and submits them; a parser task on
+ * another core consumes them in order and returns each buffer to the pool once parsed. While the
+ * parser works on page N the network stage is already downloading page N+1, so radio and CPU overlap.
+ *
+ * Both queues are bounded by the pool size, so the network stage blocks in acquire() when it runs
+ * more than poolSize pages ahead of the parser. The buffers, queues and parser task only exist
+ * between begin() and finish(), so nothing stays allocated between syncs.
+ */
+class PagePipeline : public PageSink {
+public:
+    /**
+     * Constructor for PagePipeline. Allocates nothing until begin().
+     *
+     * @param bufferSize Size of each page buffer in bytes.
+     * @param poolSize Number of page buffers in the pool.
+     * @param core CPU core the parser task is pinned to.
+     * @param priority FreeRTOS priority of the parser task.
+     */
+    PagePipeline(size_t bufferSize, size_t poolSize, BaseType_t core, UBaseType_t priority);
+    ~PagePipeline() override;
+    PagePipeline(const PagePipeline&) = delete; ///< Disable copy constructor.
+    PagePipeline& operator=(const PagePipeline&) = delete; ///< Disable assignment operator.
+
+    /**
+     * Starts a run: allocates the buffer pool and queues and starts the parser task.
+     *
+     * @param parser Callback invoked for every page on the parser task.
+     * @param context Opaque pointer handed to the parser callback.
+     * @return False if any of them could not be created; nothing stays allocated in that case.
+     */
+    bool begin(PageParser parser, void* context) override;
+
+    /**
+     * Takes an empty buffer from the pool, blocking until the parser returns one.
+     *
+     * @return An empty page buffer.
+     */
+    PageBuffer* acquire() override;
+
+    /**
+     * Hands a filled buffer to the parser task.
+     *
+     * @param page Buffer obtained from acquire().
+     */
+    void submit(PageBuffer* page) override;
+
+    /**
+     * Returns an unused buffer to the pool without parsing it.
+     *
+     * @param page Buffer obtained from acquire().
+     */
+    void release(PageBuffer* page) override;
+
+    /**
+     * @return True once the parser task failed a page of this run.
+     */
+    bool failed() const override;
+
+    /**
+     * Ends the run, waits until the parser has drained every submitted page and frees the pool,
+     * queues and parser task.
+     *
+     * @return True if every page of this run parsed successfully.
+     */
+    bool finish() override;
+
+private:
+    const size_t bufferSize;        ///< Size of each page buffer in bytes.
+    const size_t poolSize;          ///< Number of page buffers.
+    PageParser parser = nullptr;    ///< Per-page parse callback of the current run.
+    void* context = nullptr;        ///< Context handed to the parse callback.
+    const BaseType_t core;          ///< Core of the parser task.
+    const UBaseType_t priority;     ///< Priority of the parser task.
+    PageBuffer* pool = nullptr;     ///< Page buffers of the current run.
+    QueueHandle_t freePages = NULL;     ///< Empty buffers waiting for the network stage.
+    QueueHandle_t filledPages = NULL;   ///< Filled buffers waiting for the parser; nullptr ends a run.
+    SemaphoreHandle_t runFinished = NULL; ///< Given by the parser once it sees the end of a run.
+    volatile bool runOk = true;     ///< Cleared by the parser when a page fails to parse.
+
+    void freeRun(); ///< Frees the pool and queues of the current run.
+    static void parserTask(void* parameter); ///< Parser task entry point; deletes itself at the end of a run.
+};
+
+#endif // PAGE_PIPELINE_H
@@ -0,0 +1,111 @@
+#ifndef PAGE_SINK_H
+#define PAGE_SINK_H
+
+#include <cstddef>
+
+/**
+ * @brief A fixed-size buffer holding one downloaded page of a paginated API response.
+ */
+struct PageBuffer {
+    char* data = nullptr;  ///< Page body, NUL terminated.
+    size_t capacity = 0;   ///< Size of data in bytes, including room for the terminator.
+    size_t length = 0;     ///< Number of body bytes currently stored.
+};
+
+/**
+ * @brief Where the pages of a paginated download go to be parsed.
+ *
+ * The downloader takes an empty buffer with acquire(), fills it and either submits it for parsing
+ * or releases it unused. Implementations decide where parsing happens: SerialPageSink parses inside
+ * submit(), PagePipeline on a task pinned to the other core. Buffers only exist between begin() and
+ * finish(), so nothing stays allocated between syncs.
+ */
+class PageSink {
+public:
+    /**
+     * Callback run for every submitted page.
+     *
+     * @param page The page to parse. Its data may be modified (e.g. zero-copy JSON parsing).
+     * @param context Opaque pointer passed to begin().
+     * @return False to mark the whole run as failed; remaining pages are then discarded.
+     */
+    using PageParser = bool (*)(PageBuffer& page, void* context);
+
+    virtual ~PageSink() = default;
+
+    /**
+     * Starts a run and allocates its buffers.
+     *
+     * @param parser Callback invoked for every submitted page.
+     * @param context Opaque pointer handed to the parser callback.
+     * @return False if the run could not be set up; nothing stays allocated in that case.
+     */
+    virtual bool begin(PageParser parser, void* context) = 0;
+
+    /**
+     * Takes an empty buffer, blocking until one is free.
+     *
+     * @return An empty page buffer.
+     */
+    virtual PageBuffer* acquire() = 0;
+
+    /**
+     * Hands a filled buffer over for parsing.
+     *
+     * @param page Buffer obtained from acquire().
+     */
+    virtual void submit(PageBuffer* page) = 0;
+
+    /**
+     * Returns an unused buffer without parsing it.
+     *
+     * @param page Buffer obtained from acquire().
+     */
+    virtual void release(PageBuffer* page) = 0;
+
+    /**
+     * Lets the downloader stop early once the run can no longer succeed.
+     *
+     * @return True once a page of this run failed to parse.
+     */
+    virtual bool failed() const = 0;
+
+    /**
+     * Ends the run once every submitted page has been parsed, and frees the buffers.
+     *
+     * @return True if every page of this run parsed successfully.
+     */
+    virtual bool finish() = 0;
+};
+
+/**
+ * @brief Parses each page right after it is downloaded, in a single buffer (AUTH_SERIAL_SYNC).
+ */
+class SerialPageSink : public PageSink {
+public:
+    /**
+     * Constructor for SerialPageSink. Allocates nothing until begin().
+     *
+     * @param bufferSize Size of the page buffer in bytes.
+     */
+    explicit SerialPageSink(size_t bufferSize);
+    ~SerialPageSink() override;
+    SerialPageSink(const SerialPageSink&) = delete; ///< Disable copy constructor.
+    SerialPageSink& operator=(const SerialPageSink&) = delete; ///< Disable assignment operator.
+
+    bool begin(PageParser parser, void* context) override;
+    PageBuffer* acquire() override;
+    void submit(PageBuffer* page) override;
+    void release(PageBuffer* page) override;
+    bool failed() const override;
+    bool finish() override;
+
+private:
+    const size_t bufferSize;      ///< Size of the page buffer in bytes.
+    PageBuffer page;              ///< The single page buffer of the current run.
+    PageParser parser = nullptr;  ///< Per-page parse callback.
+    void* context = nullptr;      ///< Context handed to the parse callback.
+    bool runOk = true;            ///< Cleared when a page fails to parse.
+};
+
+#endif // PAGE_SINK_H
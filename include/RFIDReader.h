@@ -2,18 +2,44 @@
 #define RFID_READER_H
 
 #include <Arduino.h>
-#include "Wiegand.h"
 #include <WiFi.h>
+#include "WiegandDecoder.h"
+
+// Card format, selected at compile time with -D WIEGAND_BITS=26|34|37
+#ifndef WIEGAND_BITS
+#define WIEGAND_BITS 26
+#endif
+// Only accept cards with this facility code; -1 accepts any
+#ifndef WIEGAND_FACILITY_CODE
+#define WIEGAND_FACILITY_CODE -1
+#endif
+
+#if WIEGAND_BITS == 26
+using WiegandFormat = Wiegand26;
+#elif WIEGAND_BITS == 34
+using WiegandFormat = Wiegand34;
+#elif WIEGAND_BITS == 37
+using WiegandFormat = Wiegand37;
+#else
+#error "Unsupported WIEGAND_BITS, expected 26, 34 or 37"
+#endif
 
 /**
  * RFIDReader class.
- * Handles the reading of RFID tags using the Wiegand 26 protocol.
+ * Handles the reading of RFID tags using the Wiegand protocol (26, 34 or 37-bit, see WIEGAND_BITS).
  * This class is designed as a singleton to ensure only one instance manages the RFID hardware.
+ *
+ * Raw frames are captured bit by bit in the D0/D1 interrupt handlers. A bit arriving after the line
+ * has been idle for a frame gap starts a new frame, and the finished one is queued for pollRFIDTask,
+ * so frames stay separate however long the task sleeps. The task validates them (length, parity,
+ * facility code) with WiegandDecoder. Invalid frames are dropped here and never reach Auth or the
+ * failed-attempt backoff.
  * 
- * Note: The Wiegand 26 protocol has a fast 25ms frame time. Therefore, pinning this task to a dedicated
- * CPU core is desirable for maintaining responsiveness and ensuring reliable tag reads. This approach 
- * helps to manage the time-sensitive nature of the Wiegand protocol without interference from other 
- * tasks that the ESP32 is handling concurrently.
+ * Note: The Wiegand 26 protocol has a fast 25ms frame time. The bits themselves are captured by the
+ * interrupts, so pollRFIDTask only has to run once per frame gap to pick up a completed frame. It is
+ * pinned to core 1, where it shares the CPU with loop() (the Arduino loopTask) and doorTask at the
+ * same priority; those spend most of their time blocked on the network or in delays. During a
+ * pipelined cache refresh the page parser runs on core 0, away from this task.
  */
 class RFIDReader {
     public:
@@ -51,8 +77,27 @@ class RFIDReader {
         // Singleton instance of the RFIDReader class.
         static RFIDReader* instance;
 
-        // Wiegand interface for RFID reading.
-        WIEGAND wg;
+        static constexpr int d0Pin = 32; ///< Wiegand DATA0 input.
+        static constexpr int d1Pin = 33; ///< Wiegand DATA1 input.
+        static constexpr unsigned long frameGapMicros = 25000; ///< Line idle time that ends a frame.
+        static constexpr uint8_t maxFrameBits = 64; ///< Bits that fit in the frame buffer.
+        static constexpr uint8_t frameQueueSize = 4; ///< Completed frames held until pollRFIDTask wakes.
+
+        // Frame being received, written by the interrupt handlers.
+        static volatile uint64_t frameBits;
+        static volatile uint8_t frameBitCount;
+        static volatile unsigned long lastBitMicros;
+
+        // Completed frames, a ring buffer filled by the interrupt handlers and drained by loop().
+        static volatile uint64_t queuedFrameBits[frameQueueSize];
+        static volatile uint8_t queuedFrameBitCounts[frameQueueSize];
+        static volatile uint8_t queueHead; ///< Index of the oldest queued frame.
+        static volatile uint8_t queueLength; ///< Number of queued frames.
+        static volatile uint32_t overwrittenFrames; ///< Frames lost to a full queue since the last report.
+        static portMUX_TYPE frameMux; ///< Guards the frame being received and the queue.
+
+        // Validates completed frames before they reach Auth.
+        WiegandDecoder<WiegandFormat> decoder{WIEGAND_FACILITY_CODE};
 
         // Reference to a WiFiClient for potential network communication.
         WiFiClient& wifiClient;
@@ -67,6 +112,32 @@ class RFIDReader {
          * @param tagId The ID of the read RFID tag.
          */
         void handleTagRead(const uint32_t& tagId);
+
+        /**
+         * Takes the oldest queued frame, or else the frame being received if the line has been idle
+         * for at least frameGapMicros.
+         *
+         * @param frame Receives the raw frame bits, first bit most significant.
+         * @param bitCount Receives the number of bits in the frame.
+         * @return True if a complete frame was taken.
+         */
+        bool takeCompletedFrame(uint64_t& frame, uint8_t& bitCount);
+
+        /**
+         * Appends a bit to the frame being received, first queueing the previous frame if the line
+         * was idle for a frame gap. Called from the D0/D1 interrupt handlers.
+         *
+         * @param bit The received bit.
+         */
+        static void IRAM_ATTR appendBit(uint8_t bit);
+
+        /**
+         * Moves the frame being received into the queue, overwriting the oldest frame if it is full.
+         * Called with frameMux held.
+         */
+        static void IRAM_ATTR queueFrame();
+        static void IRAM_ATTR onData0(); ///< DATA0 falling edge: a 0 bit.
+        static void IRAM_ATTR onData1(); ///< DATA1 falling edge: a 1 bit.
 };
 
 #endif // RFID_READER_H
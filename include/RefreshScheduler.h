@@ -0,0 +1,188 @@
+#ifndef REFRESH_SCHEDULER_H
+#define REFRESH_SCHEDULER_H
+
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * @brief Decides when the next WildApricot cache refresh should run.
+ *
+ * After a successful sync the interval adapts to the observed change rate: it is halved when the
+ * membership changed and grown by half when it did not, within [minInterval, maxInterval].
+ * After a failed sync the next attempt uses exponential backoff with jitter so a recovering API is
+ * not hit by every reader at the same moment. Once the cache is older than the staleness budget,
+ * or before the first successful sync when there is no cache at all, failed attempts are retried at
+ * the (short) urgent interval instead of backing off further.
+ *
+ * The scheduler never reads the clock or a random source itself: every call takes the current time in
+ * milliseconds and the random source is passed in, so it can be driven by millis() and esp_random() on
+ * the device or by a virtual clock and a seeded generator in tests. All time arithmetic is unsigned
+ * and therefore safe across millis() overflow.
+ */
+class RefreshScheduler {
+public:
+    /**
+     * Counters describing sync outcomes since boot.
+     */
+    struct Metrics {
+        unsigned long changedSyncs = 0;        ///< Successful syncs that changed the tag set.
+        unsigned long unchangedSyncs = 0;      ///< Successful syncs that returned the same tag set.
+        unsigned long failedSyncs = 0;         ///< Failed sync attempts.
+        unsigned int consecutiveFailures = 0;  ///< Failed attempts since the last success.
+    };
+
+    /**
+     * Constructor for RefreshScheduler.
+     *
+     * @param randomSource Source of random numbers for jitter, e.g. esp_random.
+     * @param baseIntervalMs Interval used until the first sync outcome is known.
+     * @param minIntervalMs Shortest interval between successful syncs.
+     * @param maxIntervalMs Longest interval between successful syncs.
+     * @param failureDelayMs Backoff delay after the first failure; doubled per consecutive failure.
+     * @param maxFailureDelayMs Upper bound on the failure backoff delay.
+     * @param maxStalenessMs Cache age after which failed syncs are retried urgently.
+     * @param urgentRetryMs Retry delay used while the cache is stale.
+     */
+    explicit RefreshScheduler(uint32_t (*randomSource)(),
+                              unsigned long baseIntervalMs = 300000,
+                              unsigned long minIntervalMs = 120000,
+                              unsigned long maxIntervalMs = 1800000,
+                              unsigned long failureDelayMs = 15000,
+                              unsigned long maxFailureDelayMs = 600000,
+                              unsigned long maxStalenessMs = 3600000,
+                              unsigned long urgentRetryMs = 30000)
+        : minIntervalMs(minIntervalMs),
+          maxIntervalMs(maxIntervalMs),
+          failureDelayMs(failureDelayMs),
+          maxFailureDelayMs(maxFailureDelayMs),
+          maxStalenessMs(maxStalenessMs),
+          urgentRetryMs(urgentRetryMs),
+          randomSource(randomSource),
+          intervalMs(baseIntervalMs) {}
+
+    /**
+     * Checks whether a refresh should run now. A refresh is due immediately after construction.
+     *
+     * @param now Current time in milliseconds.
+     * @return True if the scheduled delay has elapsed.
+     */
+    bool isDue(unsigned long now) const {
+        return !scheduled || now - scheduledAt >= delayMs;
+    }
+
+    /**
+     * Records a successful sync and schedules the next one from the adapted interval.
+     *
+     * @param now Current time in milliseconds.
+     * @param changed True if the sync changed the cached tag set.
+     */
+    void recordSuccess(unsigned long now, bool changed) {
+        if (changed) {
+            metrics.changedSyncs++;
+            intervalMs = std::max(intervalMs / 2, minIntervalMs);
+        } else {
+            metrics.unchangedSyncs++;
+            intervalMs = std::min(intervalMs + intervalMs / 2, maxIntervalMs);
+        }
+        metrics.consecutiveFailures = 0;
+        lastSuccessAt = now;
+        hasSucceeded = true;
+
+        // +/-10% jitter keeps refreshes from settling into lockstep with other periodic work
+        schedule(now, intervalMs - intervalMs / 10 + randomBelow(intervalMs / 5 + 1));
+    }
+
+    /**
+     * Records a failed sync and schedules a retry with jittered exponential backoff,
+     * or at the urgent retry delay once the staleness budget is exhausted.
+     *
+     * @param now Current time in milliseconds.
+     */
+    void recordFailure(unsigned long now) {
+        metrics.failedSyncs++;
+        metrics.consecutiveFailures++;
+
+        unsigned int exponent = std::min(metrics.consecutiveFailures - 1, MaxBackoffExponent);
+        unsigned long backoff = std::min(failureDelayMs << exponent, maxFailureDelayMs);
+        // "Equal jitter": wait at least half the backoff, plus a random share of the other half
+        unsigned long delay = backoff / 2 + randomBelow(backoff / 2 + 1);
+
+        if (isStale(now)) {
+            delay = std::min(delay, urgentRetryMs);
+        } else {
+            // Do not sleep past the point where the cache would exceed its budget
+            unsigned long remaining = maxStalenessMs - cacheAge(now);
+            delay = std::min(delay, std::max(remaining, urgentRetryMs));
+        }
+        schedule(now, delay);
+    }
+
+    /**
+     * @param now Current time in milliseconds.
+     * @return Time since the last successful sync, or since boot if none succeeded yet.
+     */
+    unsigned long cacheAge(unsigned long now) const {
+        return hasSucceeded ? now - lastSuccessAt : now;
+    }
+
+    /**
+     * @param now Current time in milliseconds.
+     * @return True if no sync has succeeded yet (every member is denied), or the cache is older than
+     *         the staleness budget.
+     */
+    bool isStale(unsigned long now) const {
+        return !hasSucceeded || cacheAge(now) > maxStalenessMs;
+    }
+
+    /**
+     * @return Delay until the next refresh, measured from when it was scheduled.
+     */
+    unsigned long getNextDelay() const {
+        return delayMs;
+    }
+
+    /**
+     * @return Current adaptive interval between successful syncs.
+     */
+    unsigned long getInterval() const {
+        return intervalMs;
+    }
+
+    /**
+     * @return Sync outcome counters.
+     */
+    const Metrics& getMetrics() const {
+        return metrics;
+    }
+
+private:
+    static constexpr unsigned int MaxBackoffExponent = 10; ///< Caps the shift so the backoff cannot overflow.
+
+    const unsigned long minIntervalMs;     ///< Shortest interval between successful syncs.
+    const unsigned long maxIntervalMs;     ///< Longest interval between successful syncs.
+    const unsigned long failureDelayMs;    ///< Backoff delay after the first failure.
+    const unsigned long maxFailureDelayMs; ///< Upper bound on the failure backoff delay.
+    const unsigned long maxStalenessMs;    ///< Cache age after which retries become urgent.
+    const unsigned long urgentRetryMs;     ///< Retry delay while the cache is stale.
+    uint32_t (*const randomSource)();      ///< Random number source for jitter.
+
+    unsigned long intervalMs;              ///< Current adaptive interval.
+    unsigned long scheduledAt = 0;         ///< Time the next refresh was scheduled at.
+    unsigned long delayMs = 0;             ///< Delay from scheduledAt until the next refresh.
+    unsigned long lastSuccessAt = 0;       ///< Time of the last successful sync.
+    bool scheduled = false;                ///< False until the first outcome is recorded.
+    bool hasSucceeded = false;             ///< True once any sync has succeeded.
+    Metrics metrics;                       ///< Sync outcome counters.
+
+    void schedule(unsigned long now, unsigned long delay) {
+        scheduledAt = now;
+        delayMs = delay;
+        scheduled = true;
+    }
+
+    unsigned long randomBelow(unsigned long bound) const {
+        return bound == 0 ? 0 : randomSource() % bound;
+    }
+};
+
+#endif // REFRESH_SCHEDULER_H
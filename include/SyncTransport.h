@@ -0,0 +1,53 @@
+#ifndef SYNC_TRANSPORT_H
+#define SYNC_TRANSPORT_H
+
+#include <cstddef>
+
+/**
+ * @brief The HTTP exchange ContactsSync runs on, one request at a time.
+ *
+ * The firmware implements it with ArduinoHttpClient (HttpClientTransport) and the native tests with
+ * POSIX sockets against the WildApricot replay server. Everything above it, from the token request to
+ * the truncation checks, retries and parsing, is the same code in both builds.
+ */
+class SyncTransport {
+public:
+    virtual ~SyncTransport() = default;
+
+    /**
+     * Sends a request and waits for the response status.
+     *
+     * @param method "GET" or "POST".
+     * @param path Request path including the query string.
+     * @param authorization Value of the Authorization header.
+     * @param contentType Value of the Content-Type header.
+     * @param body Request body, or nullptr for none.
+     * @return HTTP status code, or a negative value if the connection failed.
+     */
+    virtual int request(const char* method, const char* path, const char* authorization,
+                        const char* contentType, const char* body) = 0;
+
+    /**
+     * Reads the response headers. Called once per response, before read().
+     *
+     * @return Content-Length of the response body, or -1 if the server sent none (e.g. chunked).
+     */
+    virtual int contentLength() = 0;
+
+    /**
+     * Reads the next part of the response body, waiting up to the response timeout for it.
+     *
+     * @param buffer Receives the data.
+     * @param size Size of buffer in bytes.
+     * @return Bytes read; 0 at the end of the body or when the server closed the connection;
+     *         negative if no data arrived within the timeout.
+     */
+    virtual int read(char* buffer, size_t size) = 0;
+
+    /**
+     * Drops the connection, e.g. after an error response or a body that was not read to the end.
+     */
+    virtual void stop() = 0;
+};
+
+#endif // SYNC_TRANSPORT_H
@@ -0,0 +1,174 @@
+#ifndef TASK_PROFILER_H
+#define TASK_PROFILER_H
+
+#include <Arduino.h>
+
+/**
+ * TaskProfiler class.
+ * Measures whether pollRFIDTask keeps its real-time margin while loop() is busy with TLS and JSON work.
+ * Only compiled into builds with -D RFID_PROFILING.
+ *
+ * Two things are collected:
+ * - Wake-up lateness of pollRFIDTask and the time between two polls, as histograms. Lateness is measured
+ *   from the tick the task asked to wake on, converted to microseconds, so it shows scheduling delay
+ *   rather than where in the tick period the task went to sleep. The poll period histogram has its
+ *   own edges around the nominal 10ms delay, plus one at the 25ms Wiegand frame time.
+ * - CPU load that works on the stock Arduino framework: per-core busy share from idle hooks, and the
+ *   esp_timer time loop(), pollRFIDTask and parsePagesTask spend between blocking calls, recorded
+ *   with BusyScope.
+ * - Per-task CPU share since the previous report, from FreeRTOS run-time stats. These need
+ *   configGENERATE_RUN_TIME_STATS and configUSE_TRACE_FACILITY, which the prebuilt Arduino framework
+ *   does not enable; the report then says so and relies on the load figures above.
+ *
+ * Samples are recorded from pollRFIDTask on core 1 and reported over serial from loop().
+ */
+class TaskProfiler {
+public:
+    /**
+     * Gets the singleton instance of the TaskProfiler class.
+     * Create it from setup() before starting pollRFIDTask.
+     *
+     * @return A pointer to the singleton TaskProfiler instance.
+     */
+    static TaskProfiler* getInstance();
+
+    /**
+     * Tasks whose busy time is accounted with BusyScope.
+     */
+    enum class TrackedTask : uint8_t {
+        Loop,        ///< loop(), network waits included.
+        PollRFID,    ///< pollRFIDTask, between delays.
+        ParsePages,  ///< The page parser of a pipelined sync.
+        Count
+    };
+
+    /**
+     * Adds the esp_timer time between construction and destruction to a task's busy time.
+     * Each TrackedTask must only be timed from one task at a time.
+     */
+    class BusyScope {
+    public:
+        explicit BusyScope(TrackedTask task);
+        ~BusyScope();
+        BusyScope(const BusyScope&) = delete;
+        BusyScope& operator=(const BusyScope&) = delete;
+
+    private:
+        TrackedTask task;
+        int64_t startMicros;
+    };
+
+    /**
+     * Records one pollRFIDTask wake-up.
+     *
+     * @param scheduledTick Tick the task asked to wake on, as updated by vTaskDelayUntil().
+     * @param actualMicros Time the task actually resumed, from esp_timer_get_time().
+     */
+    void recordWake(TickType_t scheduledTick, int64_t actualMicros);
+
+    /**
+     * Prints a report over serial if the report interval has elapsed, then starts a new window.
+     *
+     * @param now Current time in milliseconds.
+     */
+    void reportIfDue(unsigned long now);
+
+private:
+    static constexpr unsigned long reportIntervalMs = 10000; ///< Time between serial reports.
+    static constexpr size_t bucketCount = 10; ///< Number of histogram buckets.
+    static constexpr size_t maxTrackedTasks = 24; ///< Tasks remembered between run-time snapshots.
+    static constexpr size_t trackedTaskCount = static_cast<size_t>(TrackedTask::Count); ///< Tasks timed with BusyScope.
+    static constexpr int64_t idleGapMicros = 50; ///< Longer gaps between idle hook calls mean another task ran.
+    static constexpr TickType_t reanchorTicks = pdMS_TO_TICKS(60 * 60 * 1000); ///< Anchor age that triggers a re-anchor.
+    static const int64_t latenessUpperMicros[bucketCount]; ///< Lateness bucket edges; the first holds early wakes.
+    static const int64_t pollPeriodUpperMicros[bucketCount]; ///< Poll period bucket edges around the nominal delay.
+
+    /**
+     * Histogram of durations in microseconds.
+     */
+    struct Histogram {
+        const int64_t* upperMicros; ///< Exclusive upper edge of each bucket; the last one is INT64_MAX.
+        uint32_t counts[bucketCount] = {};
+        int64_t maxMicros = 0;
+        uint32_t samples = 0;
+
+        explicit Histogram(const int64_t* upperMicros) : upperMicros(upperMicros) {}
+        void record(int64_t micros);
+        String format() const;
+    };
+
+    /**
+     * Cumulative run time of a task at the previous report.
+     */
+    struct TaskSnapshot {
+        TaskHandle_t handle;
+        uint32_t runTime;
+    };
+
+    /**
+     * Private constructor for the TaskProfiler class.
+     */
+    TaskProfiler();
+
+    static TaskProfiler* instance; ///< Singleton instance of the TaskProfiler class.
+    static const char* const trackedTaskNames[trackedTaskCount]; ///< Report labels of the tracked tasks.
+
+    // Written without locking: each idle counter by its own core's idle task, each busy counter by a
+    // single task. 32-bit so reads are atomic; only differences between reports are used.
+    static volatile uint32_t idleMicros[portNUM_PROCESSORS];     ///< Idle time per core.
+    static volatile int64_t lastIdleHookMicros[portNUM_PROCESSORS]; ///< Previous idle hook call per core.
+    static volatile uint32_t busyMicros[trackedTaskCount];       ///< Busy time per tracked task.
+
+    portMUX_TYPE histogramMux = portMUX_INITIALIZER_UNLOCKED; ///< Guards the histograms across cores.
+    Histogram lateness{latenessUpperMicros};      ///< Wake-up lateness in the current window.
+    Histogram pollPeriod{pollPeriodUpperMicros};  ///< Time between consecutive wake-ups in the current window.
+    int64_t lastWakeMicros = 0;  ///< Previous wake-up, or 0 before the first one.
+    TickType_t anchorTick = 0;   ///< A tick whose start time is known...
+    int64_t anchorMicros = 0;    ///< ...and that start time, from esp_timer_get_time().
+    unsigned long lastReportTime = 0; ///< Time of the previous report.
+    TaskSnapshot previousTasks[maxTrackedTasks]; ///< Run times at the previous report.
+    size_t previousTaskCount = 0; ///< Valid entries in previousTasks.
+    uint32_t previousTotalRunTime = 0; ///< Total run time at the previous report.
+    int64_t previousReportMicros = 0; ///< esp_timer time of the previous report.
+    uint32_t previousIdleMicros[portNUM_PROCESSORS] = {}; ///< idleMicros at the previous report.
+    uint32_t previousBusyMicros[trackedTaskCount] = {}; ///< busyMicros at the previous report.
+
+    /**
+     * Waits for the next tick and anchors tick counts to esp_timer time there. Busy-waits up to one tick,
+     * so it only runs from the constructor, before pollRFIDTask starts.
+     */
+    void calibrateTickClock();
+
+    /**
+     * @param tick A tick count within about 24 days of the anchor.
+     * @return Time the tick started, in esp_timer_get_time() microseconds. Caller holds histogramMux.
+     */
+    int64_t tickToMicros(TickType_t tick) const;
+
+    /**
+     * Moves the anchor to a recent tick once it is an hour old, so tickToMicros() never sees a tick
+     * difference outside the int32 range. Caller holds histogramMux.
+     *
+     * @param tick A recent tick count.
+     */
+    void advanceAnchor(TickType_t tick);
+
+    /**
+     * Idle hook registered on every core; accumulates that core's idle time.
+     *
+     * @return False, so the idle task keeps calling it instead of waiting for the next interrupt.
+     */
+    static bool onIdle();
+
+    /**
+     * Prints the per-core busy share and the busy share of each tracked task since the previous report.
+     */
+    void reportLoad();
+
+    /**
+     * Prints the CPU share of each task since the previous report.
+     */
+    void reportTaskRunTimes();
+};
+
+#endif // TASK_PROFILER_H
@@ -0,0 +1,135 @@
+#ifndef WIEGAND_DECODER_H
+#define WIEGAND_DECODER_H
+
+#include <cstdint>
+
+/**
+ * Wiegand frame layouts. Frames are stored with the first received bit as the most significant bit,
+ * so bit position (bits - 1) is the leading parity bit and position 0 the trailing parity bit.
+ * Each parity mask covers the parity bit itself plus the payload bits it protects.
+ */
+
+/**
+ * HID H10301 26-bit: even parity, 8-bit facility code, 16-bit card number, odd parity.
+ */
+struct Wiegand26 {
+    static constexpr uint8_t bits = 26;
+    static constexpr uint8_t cardBits = 16;
+    static constexpr uint64_t evenParityMask = 0x3FFE000ULL;  ///< Positions 25..13.
+    static constexpr uint64_t oddParityMask = 0x1FFFULL;      ///< Positions 12..0.
+};
+
+/**
+ * 34-bit: even parity, 16-bit facility code, 16-bit card number, odd parity.
+ */
+struct Wiegand34 {
+    static constexpr uint8_t bits = 34;
+    static constexpr uint8_t cardBits = 16;
+    static constexpr uint64_t evenParityMask = 0x3FFFE0000ULL; ///< Positions 33..17.
+    static constexpr uint64_t oddParityMask = 0x1FFFFULL;      ///< Positions 16..0.
+};
+
+/**
+ * HID H10304 37-bit: even parity, 16-bit facility code, 19-bit card number, odd parity.
+ * The two parity ranges overlap on position 18.
+ */
+struct Wiegand37 {
+    static constexpr uint8_t bits = 37;
+    static constexpr uint8_t cardBits = 19;
+    static constexpr uint64_t evenParityMask = 0x1FFFFC0000ULL; ///< Positions 36..18.
+    static constexpr uint64_t oddParityMask = 0x7FFFFULL;       ///< Positions 18..0.
+};
+
+/**
+ * @brief Fields extracted from a valid Wiegand frame.
+ */
+struct WiegandCredential {
+    uint32_t facilityCode = 0; ///< Facility code field.
+    uint32_t cardNumber = 0;   ///< Card number field.
+    uint32_t tagId = 0;        ///< Tag ID used for authentication (see WiegandDecoder::decode).
+};
+
+/**
+ * @brief Validates and decodes raw Wiegand frames of a single, compile-time format.
+ *
+ * Every check is a handful of mask-and-parity bit operations, so frames can be validated as soon as
+ * they complete and garbage (line noise, partial frames, cards of another format) is dropped before
+ * it reaches Auth, where it would otherwise count as a failed attempt and throttle the reader.
+ *
+ * @tparam Format One of Wiegand26, Wiegand34 or Wiegand37.
+ */
+template <typename Format>
+class WiegandDecoder {
+public:
+    /**
+     * Result of decoding a frame.
+     */
+    enum class Result {
+        Ok,            ///< Frame is valid and the credential was filled in.
+        BadLength,     ///< Bit count does not match the format.
+        BadParity,     ///< Leading or trailing parity check failed.
+        WrongFacility  ///< Facility code does not match the configured one.
+    };
+
+    /**
+     * Constructor for WiegandDecoder.
+     *
+     * @param facilityCode Only accept this facility code, or -1 to accept any.
+     */
+    explicit WiegandDecoder(int32_t facilityCode = -1) : facilityCode(facilityCode) {}
+
+    /**
+     * Validates a raw frame and extracts its fields.
+     *
+     * The tag ID is the payload between the parity bits (facility code and card number), matching the
+     * value the previous Wiegand library reported for 26 and 34-bit cards. For 37-bit cards the 35-bit
+     * payload is truncated to its low 32 bits.
+     *
+     * @param frame Received bits, first bit most significant.
+     * @param bitCount Number of bits received.
+     * @param credential Filled in when the result is Result::Ok.
+     * @return Decode result.
+     */
+    Result decode(uint64_t frame, uint8_t bitCount, WiegandCredential& credential) const {
+        if (bitCount != Format::bits) {
+            return Result::BadLength;
+        }
+        if (__builtin_parityll(frame & Format::evenParityMask) != 0
+            || __builtin_parityll(frame & Format::oddParityMask) != 1) {
+            return Result::BadParity;
+        }
+
+        uint64_t payload = (frame >> 1) & PayloadMask;
+        uint32_t facility = static_cast<uint32_t>(payload >> Format::cardBits);
+        if (facilityCode >= 0 && facility != static_cast<uint32_t>(facilityCode)) {
+            return Result::WrongFacility;
+        }
+
+        credential.facilityCode = facility;
+        credential.cardNumber = static_cast<uint32_t>(payload & CardMask);
+        credential.tagId = static_cast<uint32_t>(payload);
+        return Result::Ok;
+    }
+
+    /**
+     * @param result A decode result.
+     * @return Short description for logging.
+     */
+    static const char* describe(Result result) {
+        switch (result) {
+            case Result::Ok: return "ok";
+            case Result::BadLength: return "bad length";
+            case Result::BadParity: return "bad parity";
+            case Result::WrongFacility: return "wrong facility code";
+        }
+        return "unknown";
+    }
+
+private:
+    static constexpr uint64_t PayloadMask = (1ULL << (Format::bits - 2)) - 1; ///< Bits between the parity bits.
+    static constexpr uint64_t CardMask = (1ULL << Format::cardBits) - 1;      ///< Card number field.
+
+    const int32_t facilityCode; ///< Required facility code, or -1 for any.
+};
+
+#endif // WIEGAND_DECODER_H
@@ -3,18 +3,60 @@
 #include "RFIDReader.h"
 #include <cmath> // For pow function
 
+// The WildApricot endpoint can be overridden with build flags (see README) so the
+// sync path can be pointed at a local stand-in server for offline soak testing.
+#ifndef WA_API_HOST
+#define WA_API_HOST "api.wildapricot.org"
+#endif
+#ifndef WA_API_PORT
+#define WA_API_PORT 443
+#endif
+#ifndef WA_ACCOUNT_ID
+#define WA_ACCOUNT_ID "your-wild-apricot-account-number"
+#endif
+#ifndef WA_API_KEY
+#define WA_API_KEY "your-api-key"
+#endif
+
 Auth* Auth::instance = nullptr;
-const char* Auth::tokenUrl = "https://api.wildapricot.org/auth/token";
-const char* Auth::apiEndpoint = "https://api.wildapricot.org/v2.1/accounts/your-wild-apricot-account-number/Contacts";
+const char* Auth::tokenUrl = "/auth/token";
+const char* Auth::apiEndpoint = "/v2.1/accounts/" WA_ACCOUNT_ID "/Contacts";
 const char* Auth::cacheFilePath = "/tag_ids_cache.json";
-const char* Auth::apiKey = "your-api-key";
-const char* Auth::serverName = "api.wildapricot.org"; 
-const int Auth::serverPort = 443;
+const char* Auth::apiKey = WA_API_KEY;
+const char* Auth::serverName = WA_API_HOST;
+const int Auth::serverPort = WA_API_PORT;
+const uint32_t Auth::responseTimeoutMs = 15000;
+const size_t Auth::pageBufferSize = CONTACTS_PAGE_BUFFER_SIZE;
+const uint32_t Auth::contactsPageSize = ContactsParser::contactsPerPage(CONTACTS_PAGE_BUFFER_SIZE);
+const size_t Auth::pagePoolSize = 3;
+#ifdef AUTH_SERIAL_SYNC
+const bool Auth::pipelinedSync = false;
+#else
+const bool Auth::pipelinedSync = true;
+#endif
 extern SemaphoreHandle_t delaySemaphore;
 extern volatile int rfidTaskDelay;
 
-Auth::Auth(WiFiClient& client) : wifiClient(client), httpClient(wifiClient, serverName, serverPort) {
+namespace {
+
+void logSync(const char* message) {
+    Utilities::log(message);
+}
+
+size_t largestFreeBlock() {
+    return ESP.getMaxAllocHeap();
+}
+
+}  // namespace
+
+Auth::Auth(WiFiClient& client)
+    : wifiClient(client),
+      httpClient(wifiClient, serverName, serverPort),
+      transport(httpClient, responseTimeoutMs),
+      tokenAuthorization("Basic " + base64::encode(String("APIKEY:") + apiKey)),
+      contactsSync(transport, syncConfig(), logSync, largestFreeBlock) {
     Utilities::log("[Auth] Initializing");
+    cacheMutex = xSemaphoreCreateMutex();
 
     if (!SPIFFS.begin()) {
         Utilities::log("SPIFFS Mount Failed");
@@ -42,9 +84,30 @@ void Auth::initialize() {
 
 void Auth::authenticate(const uint32_t& tagId) {
     Utilities::log("[Auth] Authenticating tag ID: " + String(tagId));
-    if (cachedTagIDs.find(tagId) != cachedTagIDs.end()) {
-        Utilities::log("[Auth] Access Granted");
+    bool granted = false;
+    uint32_t contactId = 0;
+    char displayName[MEMBER_NAME_MAX_LENGTH + 1] = "";
+    if (xSemaphoreTake(cacheMutex, portMAX_DELAY) == pdTRUE) {
+        // Only the lookup and a copy of the member happen under the lock; a refresh may free the
+        // directory as soon as it is released
+        size_t index = members.find(tagId);
+        granted = index != MemberDirectory::npos;
+        if (granted) {
+            contactId = members.getContactId(index);
+            strlcpy(displayName, members.getDisplayName(index), sizeof(displayName));
+        }
+        xSemaphoreGive(cacheMutex);
+    } else {
+        Utilities::log("[Auth] Error taking semaphore");
+    }
+
+    if (granted) {
         Door::getInstance()->unlock();
+        String member = "contact " + String(contactId);
+        if (displayName[0] != '\0') {
+            member += " (" + String(displayName) + ")";
+        }
+        Utilities::log("[Auth] Access Granted to " + member);
     } else {
         Utilities::log("[Auth] Access Denied");
         backoffHandler.failedAttempt();
@@ -58,144 +121,97 @@ void Auth::authenticate(const uint32_t& tagId) {
     }
 }
 
-void Auth::updateCache() {
-    Utilities::log("[Auth] Updating cache");
-    String authToken = getAuthToken();
-    if (!authToken.isEmpty()) {
-        auto tagIds = getTagIds(authToken);
-        if (!tagIds.empty()) {
-            cachedTagIDs = tagIds;
-            Utilities::log("[Auth] Cache updated successfully");
-        } else {
-            Utilities::log("[Auth] No tag IDs fetched");
-        }
-    } else {
-        Utilities::log("[Auth] Failed to get auth token");
+bool Auth::isTagAuthorized(const uint32_t& tagId) {
+    bool authorized = false;
+    if (xSemaphoreTake(cacheMutex, portMAX_DELAY) == pdTRUE) {
+        authorized = members.find(tagId) != MemberDirectory::npos;
+        xSemaphoreGive(cacheMutex);
     }
+    return authorized;
 }
 
-String Auth::getAuthToken() {
-    Utilities::log("[Auth] Fetching auth token");
-    httpClient.beginRequest();
-    httpClient.post(tokenUrl);
-    String encodedCredentials = base64::encode(String("APIKEY:") + apiKey);
-    httpClient.sendHeader("Authorization", "Basic " + encodedCredentials);
-    httpClient.sendHeader("Content-Type", "application/x-www-form-urlencoded");
-    httpClient.beginBody();
-    httpClient.print("grant_type=client_credentials&scope=auto");
-    httpClient.endRequest();
-
-    int statusCode = httpClient.responseStatusCode();
-    String response = httpClient.responseBody();
-
-    if (statusCode == 200) {
-        Utilities::log("[Auth] Successfully retrieved auth token");
-        DynamicJsonDocument doc(1024);
-        deserializeJson(doc, response);
-        return doc["access_token"].as<String>();
-    } else {
-        Utilities::log("[Auth] Failed to retrieve auth token, HTTP Code: " + String(statusCode));
-        return "";
-    }
+void Auth::updateCache() {
+    Utilities::log("[Auth] Updating cache");
+    fetchAndCacheRFIDData();
 }
 
-std::unordered_set<uint32_t> Auth::getTagIds(const String& authToken) {
-    Utilities::log("[Auth] Fetching tag IDs");
-    httpClient.beginRequest();
-    httpClient.get(apiEndpoint);
-    httpClient.sendHeader("Authorization", "Bearer " + authToken);
-    httpClient.sendHeader("Content-Type", "application/json");
-    httpClient.endRequest();
-
-    int httpCode = httpClient.responseStatusCode();
-    String payload = httpClient.responseBody();
-
-    if (httpCode == 200) {
-        Utilities::log("[Auth] Successfully retrieved tag data");
-        DynamicJsonDocument doc(4096);
-        deserializeJson(doc, payload);
-
-        std::unordered_set<uint32_t> tagIds;
-        JsonArray contacts = doc["Contacts"].as<JsonArray>();
-        for (JsonObject contact : contacts) {
-            uint32_t rfidValue = contact["RFIDFieldName"].as<uint32_t>();
-            if (rfidValue > 0) {
-                tagIds.insert(rfidValue);
-            }
-        }
-        return tagIds;
-    } else {
-        Utilities::log("[Auth] Failed to retrieve tag data, HTTP Code: " + String(httpCode));
-        return std::unordered_set<uint32_t>();
-    }
+ContactsSync::Config Auth::syncConfig() const {
+    ContactsSync::Config config;
+    config.tokenPath = tokenUrl;
+    config.tokenAuthorization = tokenAuthorization.c_str();
+    config.contactsPath = apiEndpoint;
+    config.pageSize = contactsPageSize;
+    return config;
 }
 
-String Auth::fetchRFIDJson(const String& authToken) {
-    Utilities::log("[Auth] Fetching RFID data");
-    httpClient.beginRequest();
-    httpClient.get(apiEndpoint);
-    httpClient.sendHeader("Authorization", "Bearer " + authToken);
-    httpClient.sendHeader("Content-Type", "application/json");
-    httpClient.endRequest();
-
-    int httpCode = httpClient.responseStatusCode();
-    String payload = httpClient.responseBody();
-
-    if (httpCode == 200) {
-        Utilities::log("[Auth] Successfully retrieved RFID data");
-        return payload;
-    } else {
-        Utilities::log("[Auth] Failed to retrieve RFID data, HTTP Code: " + String(httpCode));
-        return "";
+Auth::SyncResult Auth::cacheMembers(MemberDirectory&& directory) {
+    // Only this task replaces the directory, so comparing outside the lock is safe
+    if (directory.sameMembers(members)) {
+        // Nothing changed, so skip the flash write as well
+        Utilities::log("[Auth] RFID data unchanged");
+        return SyncResult::Unchanged;
     }
-}
-
-void Auth::parseAndCacheRFIDData(const String& jsonData) {
-    Utilities::log("[Auth] Parsing and caching RFID data");
-    DynamicJsonDocument doc(4096);
-    deserializeJson(doc, jsonData);
-
-    JsonArray contacts = doc["Contacts"].as<JsonArray>();
-    cachedTagIDs.clear();
-    for (JsonObject contact : contacts) {
-        uint32_t rfidValue = contact["RFIDFieldName"].as<uint32_t>();
-        if (rfidValue > 0) {
-            cachedTagIDs.insert(rfidValue);
-        }
+    bool tagsChanged = !directory.sameTags(members);
+    if (xSemaphoreTake(cacheMutex, portMAX_DELAY) != pdTRUE) {
+        Utilities::log("[Auth] Error taking semaphore");
+        return SyncResult::Failed;
+    }
+    // Swap so the old arena is released after the lock is dropped
+    std::swap(members, directory);
+    xSemaphoreGive(cacheMutex);
+
+    // The flash cache only holds tag IDs, and only the tag set decides who gets in, so a renamed
+    // member or a tag moved to another contact neither rewrites flash nor counts as a change
+    if (!tagsChanged) {
+        Utilities::log("[Auth] Member details updated, RFID data unchanged");
+        return SyncResult::Unchanged;
     }
 
     if (!SPIFFS.begin()) {
         Utilities::log("Failed to mount file system");
-        return;
+        return SyncResult::Changed;
     }
 
     File cacheFile = SPIFFS.open("/rfid_cache.json", FILE_WRITE);
     if (!cacheFile) {
         Utilities::log("Failed to open cache file for writing");
         SPIFFS.end();
-        return;
+        return SyncResult::Changed;
     }
 
-    for (const auto& id : cachedTagIDs) {
-        cacheFile.println(id);
+    for (size_t i = 0; i < members.size(); i++) {
+        cacheFile.println(members.getTagId(i));
     }
     cacheFile.close();
     SPIFFS.end();
     Utilities::log("[Auth] RFID data cached successfully");
+    return SyncResult::Changed;
 }
 
-void Auth::fetchAndCacheRFIDData() {
+Auth::SyncResult Auth::fetchAndCacheRFIDData() {
     Utilities::log("[Auth] Fetching and caching RFID data");
-    String authToken = getAuthToken();
-    if (!authToken.isEmpty()) {
-        String jsonData = fetchRFIDJson(authToken);
-        if (!jsonData.isEmpty()) {
-            parseAndCacheRFIDData(jsonData);
-            Utilities::log("[Auth] RFID data fetched and parsed successfully");
-        } else {
-            Utilities::log("[Auth] No RFID data to parse");
-        }
+    unsigned long start = millis();
+    MemberDirectory directory;
+    bool ok;
+    if (pipelinedSync) {
+        // Parse on the core this network stage is not running on, so download and parse really overlap.
+        // With loopTask on core 1 (the Arduino default) that is core 0, away from pollRFIDTask.
+        PagePipeline pipeline(pageBufferSize, pagePoolSize, 1 - xPortGetCoreID(), 1);
+        ok = contactsSync.sync(pipeline, directory);
     } else {
-        Utilities::log("[Auth] Failed to fetch auth token");
+        SerialPageSink serial(pageBufferSize);
+        ok = contactsSync.sync(serial, directory);
+    }
+
+    const ContactsSync::Stats& stats = contactsSync.getStats();
+    Utilities::log("[Auth] Synced " + String(stats.pages) + " pages (" + String(stats.contactCount) + " contacts) in "
+                   + String(millis() - start) + " ms, " + (pipelinedSync ? "pipelined" : "serial")
+                   + (ok ? "" : ", failed"));
+    if (!ok) {
+        // Keep serving the previous cache rather than locking every member out
+        Utilities::log("[Auth] RFID data rejected, keeping previous cache");
+        return SyncResult::Failed;
     }
+    Utilities::log("[Auth] RFID data fetched and parsed successfully");
+    return cacheMembers(std::move(directory));
 }
@@ -0,0 +1,81 @@
+#include "ContactsParser.h"
+#include <ArduinoJson.h>
+#include <cstring>
+
+constexpr size_t ContactsParser::maxContactBytes;
+constexpr size_t ContactsParser::pageEnvelopeBytes;
+const char* const ContactsParser::selectQuery = "&$select=%27Id%27,%27DisplayName%27,%27RFIDFieldName%27";
+
+ContactsParser::Result ContactsParser::parseContacts(const char* json, size_t length, MemberDirectory::Builder& builder) {
+    // Only the fields kept in the member directory are parsed, so the document stays small
+    StaticJsonDocument<128> filter;
+    filter["Contacts"][0]["RFIDFieldName"] = true;
+    filter["Contacts"][0]["Id"] = true;
+    if (builder.keepsNames()) {
+        filter["Contacts"][0]["DisplayName"] = true;
+    }
+
+    DynamicJsonDocument doc(length / 2 + 1024);
+    DeserializationError error = deserializeJson(doc, json, length, DeserializationOption::Filter(filter));
+    if (error == DeserializationError::NoMemory) {
+        return Result::NoMemory;
+    }
+    if (error) {
+        return Result::InvalidJson;
+    }
+
+    JsonArray contacts = doc["Contacts"].as<JsonArray>();
+    if (contacts.isNull()) {
+        return Result::MissingContacts;
+    }
+    for (JsonObject contact : contacts) {
+        if (!builder.add(contact["RFIDFieldName"].as<uint32_t>(), contact["Id"].as<uint32_t>(),
+                         contact["DisplayName"].as<const char*>())) {
+            return Result::TooManyMembers;
+        }
+    }
+    return Result::Ok;
+}
+
+ContactsParser::Result ContactsParser::parseCount(const char* json, size_t length, uint32_t& contactCount) {
+    StaticJsonDocument<128> doc;
+    DeserializationError error = deserializeJson(doc, json, length);
+    if (error) {
+        return error == DeserializationError::NoMemory ? Result::NoMemory : Result::InvalidJson;
+    }
+    if (!doc["Count"].is<uint32_t>()) {
+        return Result::MissingCount;
+    }
+    contactCount = doc["Count"].as<uint32_t>();
+    return Result::Ok;
+}
+
+ContactsParser::Result ContactsParser::parseToken(const char* json, size_t length, char* token, size_t tokenSize) {
+    // The rest of the response (refresh token, permissions) is skipped
+    StaticJsonDocument<32> filter;
+    filter["access_token"] = true;
+    StaticJsonDocument<384> doc; // Room for the object and a copy of a token of up to 256 bytes
+    DeserializationError error = deserializeJson(doc, json, length, DeserializationOption::Filter(filter));
+    if (error) {
+        return error == DeserializationError::NoMemory ? Result::NoMemory : Result::InvalidJson;
+    }
+    const char* value = doc["access_token"].as<const char*>();
+    if (value == nullptr || strlen(value) >= tokenSize) {
+        return Result::MissingToken;
+    }
+    strcpy(token, value);
+    return Result::Ok;
+}
+
+const char* ContactsParser::describe(Result result) {
+    switch (result) {
+        case Result::Ok: return "ok";
+        case Result::InvalidJson: return "invalid or truncated JSON";
+        case Result::NoMemory: return "JSON document too large";
+        case Result::MissingContacts: return "no Contacts array";
+        case Result::MissingCount: return "no Count";
+        case Result::MissingToken: return "no usable access_token";
+        case Result::TooManyMembers: return "more members than expected, or out of staging memory";
+    }
+    return "unknown";
+}
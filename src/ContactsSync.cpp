@@ -0,0 +1,262 @@
+#include "ContactsSync.h"
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+/**
+ * @return Explanation appended to an HTTP status in log lines, empty if there is none.
+ */
+const char* describeHttpStatus(int httpCode) {
+    if (httpCode == 401) {
+        return " (token rejected)";
+    }
+    if (httpCode == 429) {
+        return " (rate limited)";
+    }
+    if (httpCode >= 500) {
+        return " (server error)";
+    }
+    return "";
+}
+
+}  // namespace
+
+ContactsSync::ContactsSync(SyncTransport& transport, const Config& config, Logger logger,
+                           FreeBlockProbe largestFreeBlock)
+    : transport(transport),
+      config(config),
+      logger(logger),
+      largestFreeBlock(largestFreeBlock),
+      stagingMembers(config.maxNameLength) {}
+
+const ContactsSync::Stats& ContactsSync::getStats() const {
+    return stats;
+}
+
+bool ContactsSync::sync(PageSink& pages, MemberDirectory& directory) {
+    stats = Stats();
+    if (!fetchAuthToken()) {
+        return false;
+    }
+    bool ok = downloadMembers(pages, directory);
+    if (!ok && stats.httpCode == 401) {
+        // Tokens can expire mid-sync; retry once with a fresh one
+        logLine("[ContactsSync] Auth token rejected, requesting a new one");
+        ok = fetchAuthToken() && downloadMembers(pages, directory);
+    }
+    return ok;
+}
+
+bool ContactsSync::fetchAuthToken() {
+    stats.requests++;
+    stats.httpCode = transport.request("POST", config.tokenPath, config.tokenAuthorization,
+                                       "application/x-www-form-urlencoded", "grant_type=client_credentials&scope=auto");
+    if (stats.httpCode != 200) {
+        logRequestFailure("auth token", stats.httpCode);
+        transport.stop();
+        return false;
+    }
+
+    char body[tokenBodySize];
+    PageBuffer response;
+    response.data = body;
+    response.capacity = sizeof(body);
+    if (!readBody(response)) {
+        return false;
+    }
+    const size_t prefixLength = strlen("Bearer ");
+    memcpy(authorization, "Bearer ", prefixLength);
+    ContactsParser::Result result = ContactsParser::parseToken(response.data, response.length,
+                                                               authorization + prefixLength,
+                                                               sizeof(authorization) - prefixLength);
+    if (result != ContactsParser::Result::Ok) {
+        authorization[0] = '\0';
+        logLine("[ContactsSync] Malformed auth token response: %s", ContactsParser::describe(result));
+        return false;
+    }
+    return true;
+}
+
+bool ContactsSync::fetchContactCount(uint32_t& contactCount) {
+    char path[maxPathLength];
+    snprintf(path, sizeof(path), "%s?$async=false&$count=true", config.contactsPath);
+    stats.requests++;
+    stats.httpCode = transport.request("GET", path, authorization, "application/json", nullptr);
+    if (stats.httpCode != 200) {
+        logRequestFailure("contact count", stats.httpCode);
+        transport.stop();
+        return false;
+    }
+
+    char body[countBodySize];
+    PageBuffer response;
+    response.data = body;
+    response.capacity = sizeof(body);
+    if (!readBody(response)) {
+        return false;
+    }
+    ContactsParser::Result result = ContactsParser::parseCount(response.data, response.length, contactCount);
+    if (result != ContactsParser::Result::Ok) {
+        logLine("[ContactsSync] Malformed contact count response: %s", ContactsParser::describe(result));
+        return false;
+    }
+    return true;
+}
+
+bool ContactsSync::fetchContactsPage(uint32_t skip, PageBuffer& page) {
+    char path[maxPathLength];
+    snprintf(path, sizeof(path), "%s?$async=false&$top=%u&$skip=%u%s", config.contactsPath,
+             static_cast<unsigned>(config.pageSize), static_cast<unsigned>(skip),
+             config.selectFields ? ContactsParser::selectQuery : "");
+    stats.requests++;
+    stats.httpCode = transport.request("GET", path, authorization, "application/json", nullptr);
+    if (stats.httpCode != 200) {
+        char what[48];
+        snprintf(what, sizeof(what), "contacts at offset %u", static_cast<unsigned>(skip));
+        logRequestFailure(what, stats.httpCode);
+        transport.stop();
+        return false;
+    }
+    return readBody(page);
+}
+
+bool ContactsSync::readBody(PageBuffer& page) {
+    int expected = transport.contentLength();
+    if (expected >= static_cast<int>(page.capacity)) {
+        logLine("[ContactsSync] Response of %d bytes exceeds its %u byte buffer, raise CONTACTS_PAGE_BUFFER_SIZE",
+             expected, static_cast<unsigned>(page.capacity));
+        transport.stop();
+        return false;
+    }
+
+    // Read straight into the buffer; a String body would need a second, growing copy
+    page.length = 0;
+    while (expected < 0 || page.length < static_cast<size_t>(expected)) {
+        if (page.length + 1 >= page.capacity) {
+            logLine("[ContactsSync] Response exceeds its %u byte buffer, raise CONTACTS_PAGE_BUFFER_SIZE",
+                 static_cast<unsigned>(page.capacity));
+            transport.stop();
+            return false;
+        }
+        int bytesRead = transport.read(page.data + page.length, page.capacity - 1 - page.length);
+        if (bytesRead == 0) {
+            break;
+        }
+        if (bytesRead < 0) {
+            logLine("[ContactsSync] Response timed out after %u bytes", static_cast<unsigned>(page.length));
+            transport.stop();
+            return false;
+        }
+        page.length += bytesRead;
+    }
+    page.data[page.length] = '\0';
+    stats.bodyBytes += page.length;
+
+    // Without a Content-Length header (e.g. chunked) a truncated body is caught by the JSON parser instead
+    if (expected >= 0 && page.length != static_cast<size_t>(expected)) {
+        logLine("[ContactsSync] Response truncated, got %u of %d bytes", static_cast<unsigned>(page.length), expected);
+        transport.stop();
+        return false;
+    }
+    return true;
+}
+
+bool ContactsSync::parsePage(PageBuffer& page, void* context) {
+    ContactsSync* sync = static_cast<ContactsSync*>(context);
+    ContactsParser::Result result = ContactsParser::parseContacts(page.data, page.length, sync->stagingMembers);
+    if (result != ContactsParser::Result::Ok) {
+        sync->logLine("[ContactsSync] Failed to parse contacts page: %s", ContactsParser::describe(result));
+        return false;
+    }
+    return true;
+}
+
+bool ContactsSync::downloadPages(PageSink& pages, uint32_t contactCount) {
+    if (!pages.begin(parsePage, this)) {
+        logLine("[ContactsSync] Page buffers unavailable, largest free block %u bytes",
+             static_cast<unsigned>(largestFreeBlock()));
+        return false;
+    }
+
+    // Stop downloading as soon as a page fails to parse; the rest of the run could only be discarded
+    bool ok = true;
+    for (uint32_t skip = 0; ok && !pages.failed() && skip < contactCount; skip += config.pageSize) {
+        PageBuffer* page = pages.acquire();
+        if (fetchContactsPage(skip, *page)) {
+            stats.pages++;
+            pages.submit(page);
+        } else {
+            pages.release(page);
+            ok = false;
+        }
+    }
+    // Always drain the parser so its task ends and the buffers are freed
+    return pages.finish() && ok;
+}
+
+bool ContactsSync::downloadMembers(PageSink& pages, MemberDirectory& directory) {
+    uint32_t contactCount = 0;
+    if (!fetchContactCount(contactCount)) {
+        return false;
+    }
+    if (contactCount == 0) {
+        logLine("[ContactsSync] WildApricot reported no contacts");
+        return false;
+    }
+    stats.contactCount = contactCount;
+
+    // Staging grows with the tagged members as pages are parsed; the contact count only bounds it
+    stagingMembers.begin(contactCount);
+    if (!downloadPages(pages, contactCount)) {
+        if (stagingMembers.isOutOfMemory()) {
+            logLine("[ContactsSync] Not enough memory to stage members beyond %u bytes, largest free block %u bytes",
+                 static_cast<unsigned>(stagingMembers.getStagingBytes()), static_cast<unsigned>(largestFreeBlock()));
+        }
+        stagingMembers.clear();
+        return false;
+    }
+
+    if (stagingMembers.getDroppedNames() > 0) {
+        logLine("[ContactsSync] Not enough memory for %u display names",
+             static_cast<unsigned>(stagingMembers.getDroppedNames()));
+    }
+    // The staging block becomes the new arena, unless the names do not fit in its spare room
+    size_t buildBytes = stagingMembers.getBuildBytes();
+    size_t freeBlock = largestFreeBlock();
+    MemberDirectory built;
+    if (buildBytes > freeBlock || !stagingMembers.build(built)) {
+        logLine("[ContactsSync] Not enough memory for a %u byte member directory, largest free block %u bytes",
+             static_cast<unsigned>(buildBytes), static_cast<unsigned>(freeBlock));
+        stagingMembers.clear();
+        return false;
+    }
+    if (built.size() == 0) {
+        logLine("[ContactsSync] No tagged members");
+        return false;
+    }
+    logLine("[ContactsSync] Member directory: %u members in %u bytes (%.1f bytes/member)",
+         static_cast<unsigned>(built.size()), static_cast<unsigned>(built.getArenaBytes()),
+         static_cast<double>(built.getArenaBytes()) / built.size());
+    directory = std::move(built);
+    return true;
+}
+
+void ContactsSync::logRequestFailure(const char* what, int httpCode) {
+    if (httpCode < 0) {
+        logLine("[ContactsSync] Failed to retrieve %s, connection error %d", what, httpCode);
+    } else {
+        logLine("[ContactsSync] Failed to retrieve %s, HTTP %d%s", what, httpCode, describeHttpStatus(httpCode));
+    }
+}
+
+void ContactsSync::logLine(const char* format, ...) {
+    char message[160];
+    va_list arguments;
+    va_start(arguments, format);
+    vsnprintf(message, sizeof(message), format, arguments);
+    va_end(arguments);
+    logger(message);
+}
@@ -11,6 +11,7 @@ Door::Door() {
     digitalWrite(doorLockPin, HIGH); // Start with the door locked
     digitalWrite(redLightPin, HIGH); // Start with red light on
     digitalWrite(greenLightPin, LOW); // Start with green light off
+    stateMutex = xSemaphoreCreateMutex();
     Utilities::log("[Door] Initialized with door locked and red light on");
 }
 
@@ -34,8 +35,7 @@ Door* Door::getInstance() {
     return instance;
 }
 
-void Door::lock() {
-    Utilities::log("[Door] Locking door");
+void Door::relock() {
     if (!isDoorLocked) {
         digitalWrite(doorLockPin, HIGH);
         turnOnLight(redLightPin);
@@ -47,8 +47,20 @@ void Door::lock() {
     }
 }
 
+void Door::lock() {
+    Utilities::log("[Door] Locking door");
+    if (xSemaphoreTake(stateMutex, portMAX_DELAY) == pdTRUE) {
+        relock();
+        xSemaphoreGive(stateMutex);
+    }
+}
+
 void Door::unlock() {
     Utilities::log("[Door] Unlocking door");
+    if (xSemaphoreTake(stateMutex, portMAX_DELAY) != pdTRUE) {
+        Utilities::log("[Door] Error taking semaphore");
+        return;
+    }
     if (isDoorLocked) {
         digitalWrite(doorLockPin, LOW);
         turnOffLight(redLightPin);
@@ -59,12 +71,17 @@ void Door::unlock() {
     } else {
         Utilities::log("[Door] Door already unlocked");
     }
+    xSemaphoreGive(stateMutex);
 }
 
 void Door::update() {
-    Utilities::log("[Door] Updating door state");
+    // Runs every 100 ms, so only log when the door actually relocks
+    if (xSemaphoreTake(stateMutex, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
     if (!isDoorLocked && millis() - lastUnlockTime > relayUnlockDuration) {
-        lock();
         Utilities::log("[Door] Auto-relocking door");
+        relock();
     }
+    xSemaphoreGive(stateMutex);
 }
@@ -0,0 +1,50 @@
+#include "HttpClientTransport.h"
+
+HttpClientTransport::HttpClientTransport(HttpClient& client, uint32_t responseTimeoutMs)
+    : client(client), responseTimeoutMs(responseTimeoutMs) {
+    client.setHttpResponseTimeout(responseTimeoutMs);
+}
+
+int HttpClientTransport::request(const char* method, const char* path, const char* authorization,
+                                 const char* contentType, const char* body) {
+    client.beginRequest();
+    if (strcmp(method, "POST") == 0) {
+        client.post(path);
+    } else {
+        client.get(path);
+    }
+    client.sendHeader("Authorization", authorization);
+    client.sendHeader("Content-Type", contentType);
+    if (body != nullptr) {
+        client.beginBody();
+        client.print(body);
+    }
+    client.endRequest();
+    return client.responseStatusCode();
+}
+
+int HttpClientTransport::contentLength() {
+    return client.contentLength();
+}
+
+int HttpClientTransport::read(char* buffer, size_t size) {
+    unsigned long start = millis();
+    while (!client.endOfBodyReached()) {
+        int bytesRead = client.read(reinterpret_cast<uint8_t*>(buffer), size);
+        if (bytesRead > 0) {
+            return bytesRead;
+        }
+        if (!client.connected()) {
+            return 0;
+        }
+        if (millis() - start >= responseTimeoutMs) {
+            return -1;
+        }
+        delay(1);
+    }
+    return 0;
+}
+
+void HttpClientTransport::stop() {
+    client.stop();
+}
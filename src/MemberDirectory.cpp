@@ -0,0 +1,375 @@
+#include "MemberDirectory.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+constexpr size_t MemberDirectory::npos;
+constexpr size_t MemberDirectory::Builder::firstChunkMembers;
+constexpr size_t MemberDirectory::Builder::firstNamesBytes;
+constexpr size_t MemberDirectory::Builder::firstSlotCount;
+
+namespace {
+
+/**
+ * FNV-1a over the first length bytes of a name.
+ */
+uint32_t hashName(const char* name, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ static_cast<uint8_t>(name[i])) * 16777619u;
+    }
+    return hash;
+}
+
+}  // namespace
+
+MemberDirectory::~MemberDirectory() {
+    free(arena);
+}
+
+MemberDirectory::MemberDirectory(MemberDirectory&& other) noexcept {
+    *this = std::move(other);
+}
+
+MemberDirectory& MemberDirectory::operator=(MemberDirectory&& other) noexcept {
+    if (this != &other) {
+        free(arena);
+        arena = other.arena;
+        arenaBytes = other.arenaBytes;
+        count = other.count;
+        tagIds = other.tagIds;
+        contactIds = other.contactIds;
+        nameOffsets = other.nameOffsets;
+        names = other.names;
+        other.arena = nullptr;
+        other.arenaBytes = 0;
+        other.count = 0;
+        other.tagIds = nullptr;
+        other.contactIds = nullptr;
+        other.nameOffsets = nullptr;
+        other.names = nullptr;
+    }
+    return *this;
+}
+
+size_t MemberDirectory::find(uint32_t tagId) const {
+    const uint32_t* end = tagIds + count;
+    const uint32_t* match = std::lower_bound(tagIds, end, tagId);
+    return (match != end && *match == tagId) ? static_cast<size_t>(match - tagIds) : npos;
+}
+
+uint32_t MemberDirectory::getContactId(size_t index) const {
+    return contactIds[index];
+}
+
+const char* MemberDirectory::getDisplayName(size_t index) const {
+    return nameOffsets != nullptr ? names + nameOffsets[index] : "";
+}
+
+uint32_t MemberDirectory::getTagId(size_t index) const {
+    return tagIds[index];
+}
+
+size_t MemberDirectory::size() const {
+    return count;
+}
+
+size_t MemberDirectory::getArenaBytes() const {
+    return arenaBytes;
+}
+
+bool MemberDirectory::sameMembers(const MemberDirectory& other) const {
+    if (count != other.count) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (tagIds[i] != other.tagIds[i] || contactIds[i] != other.contactIds[i]
+            || strcmp(getDisplayName(i), other.getDisplayName(i)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MemberDirectory::sameTags(const MemberDirectory& other) const {
+    return count == other.count && (count == 0 || memcmp(tagIds, other.tagIds, count * sizeof(uint32_t)) == 0);
+}
+
+MemberDirectory::Builder::Builder(size_t maxNameLength)
+    : maxNameLength(maxNameLength), columnCount(maxNameLength > 0 ? 3 : 2) {}
+
+MemberDirectory::Builder::~Builder() {
+    clear();
+}
+
+void MemberDirectory::Builder::begin(size_t expectedMembers) {
+    clear();
+    // Slack for members added between the count request and the last page
+    memberLimit = expectedMembers + expectedMembers / 16 + 16;
+}
+
+bool MemberDirectory::Builder::keepsNames() const {
+    return maxNameLength > 0;
+}
+
+bool MemberDirectory::Builder::isOutOfMemory() const {
+    return outOfMemory;
+}
+
+uint32_t* MemberDirectory::Builder::column(size_t index) const {
+    return columns + index * memberCapacity;
+}
+
+bool MemberDirectory::Builder::add(uint32_t tagId, uint32_t contactId, const char* displayName) {
+    if (tagId == 0) {
+        return true;
+    }
+    if (memberCount == memberLimit) {
+        return false;
+    }
+    if (memberCount == memberCapacity && !growMembers()) {
+        outOfMemory = true;
+        return false;
+    }
+    column(0)[memberCount] = tagId;
+    column(1)[memberCount] = contactId;
+    if (keepsNames()) {
+        column(2)[memberCount] = internName(displayName);
+    }
+    memberCount++;
+    return true;
+}
+
+bool MemberDirectory::Builder::growMembers() {
+    // A quarter at a time, so the block never runs far ahead of the tagged members
+    size_t capacity = std::min(std::max(memberCapacity + memberCapacity / 4, firstChunkMembers), memberLimit);
+    uint32_t* grown = static_cast<uint32_t*>(realloc(columns, capacity * columnCount * sizeof(uint32_t)));
+    if (grown == nullptr) {
+        return false;
+    }
+    // Every column but the first moves up to its new start; the last one first so none is overwritten
+    for (size_t i = columnCount - 1; i > 0; i--) {
+        memmove(grown + i * capacity, grown + i * memberCapacity, memberCount * sizeof(uint32_t));
+    }
+    columns = grown;
+    memberCapacity = capacity;
+    return true;
+}
+
+uint32_t MemberDirectory::Builder::internName(const char* displayName) {
+    if (!keepsNames() || displayName == nullptr || displayName[0] == '\0') {
+        return 0;
+    }
+
+    size_t length = strnlen(displayName, maxNameLength);
+    // Do not cut a UTF-8 sequence in half when truncating
+    while (length > 0 && (static_cast<uint8_t>(displayName[length]) & 0xC0) == 0x80) {
+        length--;
+    }
+
+    // Keep the table at most two thirds full, so probing stays short and always finds a free slot
+    if ((nameCount + 1) * 3 > slotCount * 2 && !growSlots()) {
+        droppedNames++;
+        return 0;
+    }
+
+    // Linear probing
+    size_t mask = slotCount - 1;
+    for (size_t slot = hashName(displayName, length) & mask;; slot = (slot + 1) & mask) {
+        uint32_t offset = nameSlots[slot];
+        if (offset == 0) {
+            if (!growNames(length + 1)) {
+                droppedNames++;
+                return 0;
+            }
+            offset = namesLength;
+            memcpy(names + offset, displayName, length);
+            names[offset + length] = '\0';
+            namesLength += length + 1;
+            nameSlots[slot] = offset;
+            nameCount++;
+            return offset;
+        }
+        if (strncmp(names + offset, displayName, length) == 0 && names[offset + length] == '\0') {
+            return offset;
+        }
+    }
+}
+
+bool MemberDirectory::Builder::growNames(size_t needed) {
+    if (names == nullptr) {
+        names = static_cast<char*>(malloc(firstNamesBytes));
+        if (names == nullptr) {
+            return false;
+        }
+        namesCapacity = firstNamesBytes;
+        names[0] = '\0'; // Offset 0 is the shared empty name
+        namesLength = 1;
+    }
+    if (namesLength + needed <= namesCapacity) {
+        return true;
+    }
+    size_t capacity = std::max(namesCapacity + namesCapacity / 2, namesLength + needed);
+    char* grown = static_cast<char*>(realloc(names, capacity));
+    if (grown == nullptr) {
+        return false;
+    }
+    names = grown;
+    namesCapacity = capacity;
+    return true;
+}
+
+bool MemberDirectory::Builder::growSlots() {
+    size_t count = slotCount > 0 ? slotCount * 2 : firstSlotCount;
+    uint32_t* slots = static_cast<uint32_t*>(calloc(count, sizeof(uint32_t)));
+    if (slots == nullptr) {
+        return false;
+    }
+    size_t mask = count - 1;
+    for (size_t i = 0; i < slotCount; i++) {
+        uint32_t offset = nameSlots[i];
+        if (offset == 0) {
+            continue;
+        }
+        size_t slot = hashName(names + offset, strlen(names + offset)) & mask;
+        while (slots[slot] != 0) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = offset;
+    }
+    free(nameSlots);
+    nameSlots = slots;
+    slotCount = count;
+    return true;
+}
+
+size_t MemberDirectory::Builder::arenaBytesFor(size_t count) const {
+    size_t namesBytes = keepsNames() ? std::max(namesLength, static_cast<size_t>(1)) : 0;
+    return columnCount * count * sizeof(uint32_t) + namesBytes;
+}
+
+size_t MemberDirectory::Builder::getBuildBytes() const {
+    if (memberCount == 0) {
+        return 0;
+    }
+    // build() shrinks the staging block in place unless the names do not fit in its spare room
+    size_t arenaBytes = arenaBytesFor(memberCount);
+    return arenaBytes <= memberCapacity * columnCount * sizeof(uint32_t) ? 0 : arenaBytes;
+}
+
+size_t MemberDirectory::Builder::getStagingBytes() const {
+    return memberCapacity * columnCount * sizeof(uint32_t) + namesCapacity + slotCount * sizeof(uint32_t);
+}
+
+size_t MemberDirectory::Builder::getDroppedNames() const {
+    return droppedNames;
+}
+
+bool MemberDirectory::Builder::memberLess(size_t a, size_t b) const {
+    const uint32_t* tags = column(0);
+    const uint32_t* contacts = column(1);
+    return tags[a] != tags[b] ? tags[a] < tags[b] : contacts[a] < contacts[b];
+}
+
+void MemberDirectory::Builder::swapMembers(size_t a, size_t b) {
+    for (size_t i = 0; i < columnCount; i++) {
+        std::swap(column(i)[a], column(i)[b]);
+    }
+}
+
+void MemberDirectory::Builder::siftDown(size_t root, size_t end) {
+    for (size_t child = 2 * root + 1; child < end; root = child, child = 2 * root + 1) {
+        if (child + 1 < end && memberLess(child, child + 1)) {
+            child++;
+        }
+        if (!memberLess(root, child)) {
+            return;
+        }
+        swapMembers(root, child);
+    }
+}
+
+void MemberDirectory::Builder::sortMembers() {
+    // Heapsort across the columns: in place, so sorting needs no memory beyond the staging block
+    for (size_t root = memberCount / 2; root-- > 0;) {
+        siftDown(root, memberCount);
+    }
+    for (size_t end = memberCount; end-- > 1;) {
+        swapMembers(0, end);
+        siftDown(0, end);
+    }
+}
+
+bool MemberDirectory::Builder::build(MemberDirectory& directory) {
+    // The slot table is only needed while adding
+    free(nameSlots);
+    nameSlots = nullptr;
+    slotCount = 0;
+
+    MemberDirectory built;
+    if (memberCount > 0) {
+        // Sorting on the contact ID as well makes the lowest contact ID win regardless of page order
+        sortMembers();
+        size_t count = 1;
+        for (size_t i = 1; i < memberCount; i++) {
+            if (column(0)[i] != column(0)[count - 1]) {
+                for (size_t c = 0; c < columnCount; c++) {
+                    column(c)[count] = column(c)[i];
+                }
+                count++;
+            }
+        }
+
+        // Close the gaps between the columns, then shrink the block into the arena
+        for (size_t c = 1; c < columnCount; c++) {
+            memmove(columns + c * count, column(c), count * sizeof(uint32_t));
+        }
+        size_t columnBytes = count * sizeof(uint32_t);
+        size_t arenaBytes = arenaBytesFor(count);
+        uint8_t* arena = static_cast<uint8_t*>(realloc(columns, arenaBytes));
+        if (arena == nullptr) {
+            clear();
+            return false;
+        }
+        columns = nullptr;
+        memberCapacity = 0;
+        memberCount = 0;
+
+        built.arena = arena;
+        built.arenaBytes = arenaBytes;
+        built.count = count;
+        built.tagIds = reinterpret_cast<const uint32_t*>(arena);
+        built.contactIds = reinterpret_cast<const uint32_t*>(arena + columnBytes);
+        if (keepsNames()) {
+            char* namePool = reinterpret_cast<char*>(arena + 3 * columnBytes);
+            if (namesLength > 0) {
+                memcpy(namePool, names, namesLength);
+            } else {
+                namePool[0] = '\0';
+            }
+            built.nameOffsets = reinterpret_cast<const uint32_t*>(arena + 2 * columnBytes);
+            built.names = namePool;
+        }
+    }
+    clear();
+    directory = std::move(built);
+    return true;
+}
+
+void MemberDirectory::Builder::clear() {
+    free(columns);
+    free(names);
+    free(nameSlots);
+    columns = nullptr;
+    names = nullptr;
+    nameSlots = nullptr;
+    memberCount = 0;
+    memberCapacity = 0;
+    memberLimit = 0;
+    namesLength = 0;
+    namesCapacity = 0;
+    slotCount = 0;
+    nameCount = 0;
+    droppedNames = 0;
+    outOfMemory = false;
+}
@@ -0,0 +1,124 @@
+#include "PagePipeline.h"
+#include "Utilities.h"
+#include <new>
+#ifdef RFID_PROFILING
+#include "TaskProfiler.h"
+#endif
+
+PagePipeline::PagePipeline(size_t bufferSize, size_t poolSize, BaseType_t core, UBaseType_t priority)
+    : bufferSize(bufferSize), poolSize(poolSize), core(core), priority(priority) {}
+
+PagePipeline::~PagePipeline() {
+    freeRun();
+}
+
+bool PagePipeline::begin(PageParser parser, void* context) {
+    this->parser = parser;
+    this->context = context;
+    runOk = true;
+    freePages = xQueueCreate(poolSize, sizeof(PageBuffer*));
+    // One extra slot so the end-of-run marker never blocks behind a full queue
+    filledPages = xQueueCreate(poolSize + 1, sizeof(PageBuffer*));
+    runFinished = xSemaphoreCreateBinary();
+    pool = new (std::nothrow) PageBuffer[poolSize];
+    if (freePages == NULL || filledPages == NULL || runFinished == NULL || pool == nullptr) {
+        Utilities::log("[PagePipeline] Failed to create queues");
+        freeRun();
+        return false;
+    }
+
+    for (size_t i = 0; i < poolSize; i++) {
+        pool[i].data = static_cast<char*>(malloc(bufferSize));
+        if (pool[i].data == nullptr) {
+            Utilities::log("[PagePipeline] Failed to allocate page buffer " + String(i) + ", free heap "
+                           + String(ESP.getFreeHeap()) + " bytes");
+            freeRun();
+            return false;
+        }
+        pool[i].capacity = bufferSize;
+        PageBuffer* page = &pool[i];
+        xQueueSend(freePages, &page, 0);
+    }
+
+    if (xTaskCreatePinnedToCore(parserTask, "parsePagesTask", 8192, this, priority, NULL, core) != pdPASS) {
+        Utilities::log("[PagePipeline] Failed to start parser task");
+        freeRun();
+        return false;
+    }
+    return true;
+}
+
+PageBuffer* PagePipeline::acquire() {
+    PageBuffer* page = nullptr;
+    xQueueReceive(freePages, &page, portMAX_DELAY);
+    page->length = 0;
+    return page;
+}
+
+void PagePipeline::submit(PageBuffer* page) {
+    xQueueSend(filledPages, &page, portMAX_DELAY);
+}
+
+void PagePipeline::release(PageBuffer* page) {
+    xQueueSend(freePages, &page, portMAX_DELAY);
+}
+
+bool PagePipeline::failed() const {
+    return !runOk;
+}
+
+bool PagePipeline::finish() {
+    PageBuffer* endOfRun = nullptr;
+    xQueueSend(filledPages, &endOfRun, portMAX_DELAY);
+    // The parser gives this as its last action, so the queues and buffers are no longer in use
+    xSemaphoreTake(runFinished, portMAX_DELAY);
+    freeRun();
+    return runOk;
+}
+
+void PagePipeline::freeRun() {
+    if (pool != nullptr) {
+        for (size_t i = 0; i < poolSize; i++) {
+            free(pool[i].data);
+        }
+        delete[] pool;
+        pool = nullptr;
+    }
+    if (freePages != NULL) {
+        vQueueDelete(freePages);
+        freePages = NULL;
+    }
+    if (filledPages != NULL) {
+        vQueueDelete(filledPages);
+        filledPages = NULL;
+    }
+    if (runFinished != NULL) {
+        vSemaphoreDelete(runFinished);
+        runFinished = NULL;
+    }
+}
+
+void PagePipeline::parserTask(void* parameter) {
+    PagePipeline* pipeline = static_cast<PagePipeline*>(parameter);
+    for (;;) {
+        PageBuffer* page = nullptr;
+        if (xQueueReceive(pipeline->filledPages, &page, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        if (page == nullptr) {
+            break;
+        }
+        // After a failure the rest of the run is only drained, not parsed
+        if (pipeline->runOk) {
+#ifdef RFID_PROFILING
+            TaskProfiler::BusyScope busy(TaskProfiler::TrackedTask::ParsePages);
+#endif
+            if (!pipeline->parser(*page, pipeline->context)) {
+                pipeline->runOk = false;
+            }
+        }
+        pipeline->release(page);
+    }
+    xSemaphoreGive(pipeline->runFinished);
+    vTaskDelete(NULL);
+}
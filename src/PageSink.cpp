@@ -0,0 +1,43 @@
+#include "PageSink.h"
+#include <cstdlib>
+
+SerialPageSink::SerialPageSink(size_t bufferSize) : bufferSize(bufferSize) {}
+
+SerialPageSink::~SerialPageSink() {
+    free(page.data);
+}
+
+bool SerialPageSink::begin(PageParser parser, void* context) {
+    this->parser = parser;
+    this->context = context;
+    runOk = true;
+    page.data = static_cast<char*>(malloc(bufferSize));
+    page.capacity = page.data != nullptr ? bufferSize : 0;
+    return page.data != nullptr;
+}
+
+PageBuffer* SerialPageSink::acquire() {
+    page.length = 0;
+    return &page;
+}
+
+void SerialPageSink::submit(PageBuffer* page) {
+    if (runOk && !parser(*page, context)) {
+        runOk = false;
+    }
+}
+
+void SerialPageSink::release(PageBuffer*) {
+    // The single buffer is simply reused by the next acquire()
+}
+
+bool SerialPageSink::failed() const {
+    return !runOk;
+}
+
+bool SerialPageSink::finish() {
+    free(page.data);
+    page.data = nullptr;
+    page.capacity = 0;
+    return runOk;
+}
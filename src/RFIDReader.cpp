@@ -3,13 +3,24 @@
 #include "Utilities.h"
 
 RFIDReader* RFIDReader::instance = nullptr;
+volatile uint64_t RFIDReader::frameBits = 0;
+volatile uint8_t RFIDReader::frameBitCount = 0;
+volatile unsigned long RFIDReader::lastBitMicros = 0;
+volatile uint64_t RFIDReader::queuedFrameBits[RFIDReader::frameQueueSize] = {};
+volatile uint8_t RFIDReader::queuedFrameBitCounts[RFIDReader::frameQueueSize] = {};
+volatile uint8_t RFIDReader::queueHead = 0;
+volatile uint8_t RFIDReader::queueLength = 0;
+volatile uint32_t RFIDReader::overwrittenFrames = 0;
+portMUX_TYPE RFIDReader::frameMux = portMUX_INITIALIZER_UNLOCKED;
 
 RFIDReader::RFIDReader(WiFiClient& client) : wifiClient(client) {
     Utilities::log("[RFIDReader] Constructor");
-    // Initialize the Wiegand interface here
-    // e.g., wg.begin(D0, D1);
-    Utilities::log("[RFIDReader] Wiegand interface initialized");
-    
+    pinMode(d0Pin, INPUT);
+    pinMode(d1Pin, INPUT);
+    attachInterrupt(digitalPinToInterrupt(d0Pin), onData0, FALLING);
+    attachInterrupt(digitalPinToInterrupt(d1Pin), onData1, FALLING);
+    Utilities::log("[RFIDReader] Wiegand " + String(WiegandFormat::bits) + "-bit interface initialized");
+
 }
 
 RFIDReader* RFIDReader::getInstance(WiFiClient& client) {
@@ -21,13 +32,32 @@ RFIDReader* RFIDReader::getInstance(WiFiClient& client) {
 
 void RFIDReader::loop() {
     //Utilities::log("[RFIDReader] Checking for tag");
-    if (wg.available()) {
-        uint32_t tagId = uint32_t(wg.getCode());
-        handleTagRead(tagId);
+    portENTER_CRITICAL(&frameMux);
+    uint32_t overwritten = overwrittenFrames;
+    overwrittenFrames = 0;
+    portEXIT_CRITICAL(&frameMux);
+    if (overwritten > 0) {
+        Utilities::log("[RFIDReader] Frame queue full, lost " + String(overwritten) + " older frames");
+    }
+
+    // Invalid frames are skipped in the same pass, so noise queued while the task slept does not
+    // delay the card read that followed it; at most one tag reaches Auth per pass
+    uint64_t frame;
+    uint8_t bitCount;
+    while (takeCompletedFrame(frame, bitCount)) {
+        WiegandCredential credential;
+        auto result = decoder.decode(frame, bitCount, credential);
+        if (result != WiegandDecoder<WiegandFormat>::Result::Ok) {
+            // Noise or an unsupported card: drop it without touching Auth or the backoff
+            Utilities::log("[RFIDReader] Dropped " + String(bitCount) + "-bit frame: "
+                           + WiegandDecoder<WiegandFormat>::describe(result));
+            continue;
+        }
+        handleTagRead(credential.tagId);
         delay(readDelay);
-    } else {
-        //Utilities::log("[RFIDReader] No tag detected");
+        return;
     }
+    //Utilities::log("[RFIDReader] No tag detected");
 }
 
 void RFIDReader::adjustDelay(unsigned long newDelay) {
@@ -35,6 +65,62 @@ void RFIDReader::adjustDelay(unsigned long newDelay) {
 }
 
 void RFIDReader::handleTagRead(const uint32_t& tagId) {
-    Utilities::log("[RFIDReader] Tag Read: " + tagId);
+    Utilities::log("[RFIDReader] Tag Read: " + String(tagId));
     Auth::getInstance(wifiClient)->authenticate(tagId);
 }
+
+bool RFIDReader::takeCompletedFrame(uint64_t& frame, uint8_t& bitCount) {
+    bool complete = false;
+    portENTER_CRITICAL(&frameMux);
+    // The last frame of a burst has no following bit to end it in the interrupt handler
+    if (frameBitCount > 0 && micros() - lastBitMicros >= frameGapMicros) {
+        queueFrame();
+    }
+    if (queueLength > 0) {
+        frame = queuedFrameBits[queueHead];
+        bitCount = queuedFrameBitCounts[queueHead];
+        queueHead = (queueHead + 1) % frameQueueSize;
+        queueLength--;
+        complete = true;
+    }
+    portEXIT_CRITICAL(&frameMux);
+    return complete;
+}
+
+void IRAM_ATTR RFIDReader::appendBit(uint8_t bit) {
+    portENTER_CRITICAL_ISR(&frameMux);
+    unsigned long now = micros();
+    if (frameBitCount > 0 && now - lastBitMicros >= frameGapMicros) {
+        queueFrame();
+    }
+    frameBits = (frameBits << 1) | bit;
+    // Overlong frames keep counting so the decoder rejects them on length
+    if (frameBitCount <= maxFrameBits) {
+        frameBitCount++;
+    }
+    lastBitMicros = now;
+    portEXIT_CRITICAL_ISR(&frameMux);
+}
+
+void IRAM_ATTR RFIDReader::queueFrame() {
+    if (queueLength == frameQueueSize) {
+        // Keep the newest frames: the last swipe is the one someone is waiting on
+        queueHead = (queueHead + 1) % frameQueueSize;
+        queueLength--;
+        overwrittenFrames++;
+    }
+    uint8_t tail = (queueHead + queueLength) % frameQueueSize;
+    queuedFrameBits[tail] = frameBits;
+    queuedFrameBitCounts[tail] = frameBitCount;
+    queueLength++;
+    frameBits = 0;
+    frameBitCount = 0;
+}
+
+void IRAM_ATTR RFIDReader::onData0() {
+    appendBit(0);
+}
+
+void IRAM_ATTR RFIDReader::onData1() {
+    appendBit(1);
+}
@@ -0,0 +1,222 @@
+#include "TaskProfiler.h"
+#include "Utilities.h"
+#include <algorithm>
+#include <esp_freertos_hooks.h>
+#include <esp_timer.h>
+
+#ifdef RFID_PROFILING
+
+#ifdef configRUN_TIME_COUNTER_TYPE
+typedef configRUN_TIME_COUNTER_TYPE RunTimeCounter;
+#else
+typedef uint32_t RunTimeCounter;
+#endif
+
+TaskProfiler* TaskProfiler::instance = nullptr;
+const char* const TaskProfiler::trackedTaskNames[TaskProfiler::trackedTaskCount] = {
+    "loop", "pollRFIDTask", "parsePagesTask"
+};
+volatile uint32_t TaskProfiler::idleMicros[portNUM_PROCESSORS] = {};
+volatile int64_t TaskProfiler::lastIdleHookMicros[portNUM_PROCESSORS] = {};
+volatile uint32_t TaskProfiler::busyMicros[TaskProfiler::trackedTaskCount] = {};
+const int64_t TaskProfiler::latenessUpperMicros[TaskProfiler::bucketCount] = {
+    0, 100, 250, 500, 1000, 2000, 5000, 10000, 25000, INT64_MAX
+};
+const int64_t TaskProfiler::pollPeriodUpperMicros[TaskProfiler::bucketCount] = {
+    8000, 9000, 9500, 10500, 11000, 12000, 15000, 20000, 25000, INT64_MAX
+};
+
+TaskProfiler::TaskProfiler() {
+    // Once is enough: the tick interrupt and esp_timer run off the same crystal and do not drift apart,
+    // advanceAnchor() only keeps the tick differences small
+    calibrateTickClock();
+    previousReportMicros = esp_timer_get_time();
+    for (UBaseType_t core = 0; core < portNUM_PROCESSORS; core++) {
+        if (esp_register_freertos_idle_hook_for_cpu(onIdle, core) != ESP_OK) {
+            Utilities::log("[TaskProfiler] Failed to register idle hook on core " + String(core));
+        }
+    }
+    Utilities::log("[TaskProfiler] Profiling enabled, reporting every " + String(reportIntervalMs / 1000) + " s");
+}
+
+TaskProfiler* TaskProfiler::getInstance() {
+    if (instance == nullptr) {
+        instance = new TaskProfiler();
+    }
+    return instance;
+}
+
+TaskProfiler::BusyScope::BusyScope(TrackedTask task) : task(task), startMicros(esp_timer_get_time()) {}
+
+TaskProfiler::BusyScope::~BusyScope() {
+    busyMicros[static_cast<size_t>(task)] += static_cast<uint32_t>(esp_timer_get_time() - startMicros);
+}
+
+bool TaskProfiler::onIdle() {
+    BaseType_t core = xPortGetCoreID();
+    int64_t now = esp_timer_get_time();
+    int64_t gap = now - lastIdleHookMicros[core];
+    // Back-to-back calls mean the core stayed idle; a longer gap means another task or a long ISR ran
+    if (gap < idleGapMicros) {
+        idleMicros[core] += static_cast<uint32_t>(gap);
+    }
+    lastIdleHookMicros[core] = now;
+    return false;
+}
+
+void TaskProfiler::Histogram::record(int64_t micros) {
+    size_t bucket = 0;
+    while (bucket < bucketCount - 1 && micros >= upperMicros[bucket]) {
+        bucket++;
+    }
+    counts[bucket]++;
+    samples++;
+    if (micros > maxMicros) {
+        maxMicros = micros;
+    }
+}
+
+String TaskProfiler::Histogram::format() const {
+    String line = "n=" + String(samples) + " max=" + String(static_cast<long>(maxMicros)) + "us |";
+    for (size_t i = 0; i < bucketCount; i++) {
+        if (i == 0 && upperMicros[0] == 0) {
+            line += " early:";
+        } else if (i == bucketCount - 1) {
+            line += " >=" + String(static_cast<long>(upperMicros[i - 1])) + ":";
+        } else {
+            line += " <" + String(static_cast<long>(upperMicros[i])) + ":";
+        }
+        line += String(counts[i]);
+    }
+    return line;
+}
+
+void TaskProfiler::calibrateTickClock() {
+    TickType_t start = xTaskGetTickCount();
+    TickType_t tick;
+    while ((tick = xTaskGetTickCount()) == start) {
+    }
+    int64_t micros = esp_timer_get_time();
+    portENTER_CRITICAL(&histogramMux);
+    anchorTick = tick;
+    anchorMicros = micros;
+    portEXIT_CRITICAL(&histogramMux);
+}
+
+int64_t TaskProfiler::tickToMicros(TickType_t tick) const {
+    // Signed difference, so ticks just before the anchor and tick counter overflow both work
+    int32_t ticks = static_cast<int32_t>(tick - anchorTick);
+    return anchorMicros + int64_t(ticks) * portTICK_PERIOD_MS * 1000;
+}
+
+void TaskProfiler::advanceAnchor(TickType_t tick) {
+    // Tick differences past 2^31 (24.8 days at 1 kHz) would flip sign in tickToMicros()
+    if (static_cast<int32_t>(tick - anchorTick) >= static_cast<int32_t>(reanchorTicks)) {
+        anchorMicros = tickToMicros(tick);
+        anchorTick = tick;
+    }
+}
+
+void TaskProfiler::recordWake(TickType_t scheduledTick, int64_t actualMicros) {
+    portENTER_CRITICAL(&histogramMux);
+    advanceAnchor(scheduledTick);
+    lateness.record(actualMicros - tickToMicros(scheduledTick));
+    if (lastWakeMicros != 0) {
+        pollPeriod.record(actualMicros - lastWakeMicros);
+    }
+    lastWakeMicros = actualMicros;
+    portEXIT_CRITICAL(&histogramMux);
+}
+
+void TaskProfiler::reportIfDue(unsigned long now) {
+    if (now - lastReportTime < reportIntervalMs) {
+        return;
+    }
+    lastReportTime = now;
+
+    // Swap the windows out under the lock and format them afterwards, so pollRFIDTask never waits on Serial
+    portENTER_CRITICAL(&histogramMux);
+    // Also advanced here in case pollRFIDTask stops waking up
+    advanceAnchor(xTaskGetTickCount());
+    Histogram latenessWindow = lateness;
+    Histogram pollPeriodWindow = pollPeriod;
+    lateness = Histogram(latenessUpperMicros);
+    pollPeriod = Histogram(pollPeriodUpperMicros);
+    portEXIT_CRITICAL(&histogramMux);
+
+    Utilities::log("[TaskProfiler] Report from core " + String(xPortGetCoreID())
+                   + ", free heap " + String(ESP.getFreeHeap()) + " bytes");
+    Utilities::log("[TaskProfiler] pollRFIDTask wake lateness: " + latenessWindow.format());
+    Utilities::log("[TaskProfiler] pollRFIDTask poll period: " + pollPeriodWindow.format());
+    reportLoad();
+    reportTaskRunTimes();
+}
+
+void TaskProfiler::reportLoad() {
+    int64_t nowMicros = esp_timer_get_time();
+    float windowMicros = static_cast<float>(nowMicros - previousReportMicros);
+    previousReportMicros = nowMicros;
+
+    String line = "[TaskProfiler] Core busy (idle hooks):";
+    for (size_t core = 0; core < portNUM_PROCESSORS; core++) {
+        uint32_t idle = idleMicros[core];
+        float busy = 100.0f - 100.0f * (idle - previousIdleMicros[core]) / windowMicros;
+        previousIdleMicros[core] = idle;
+        line += " core" + String(core) + "=" + String(std::max(busy, 0.0f), 1) + "%";
+    }
+    Utilities::log(line);
+
+    // Wall time between blocking calls, as a share of one core; loop() includes its network waits
+    line = "[TaskProfiler] Task busy (esp_timer):";
+    for (size_t i = 0; i < trackedTaskCount; i++) {
+        uint32_t busy = busyMicros[i];
+        line += " " + String(trackedTaskNames[i]) + "="
+                + String(100.0f * (busy - previousBusyMicros[i]) / windowMicros, 1) + "%";
+        previousBusyMicros[i] = busy;
+    }
+    Utilities::log(line);
+}
+
+void TaskProfiler::reportTaskRunTimes() {
+#if (configGENERATE_RUN_TIME_STATS == 1) && (configUSE_TRACE_FACILITY == 1)
+    UBaseType_t taskCount = uxTaskGetNumberOfTasks();
+    TaskStatus_t* tasks = static_cast<TaskStatus_t*>(malloc(taskCount * sizeof(TaskStatus_t)));
+    if (tasks == nullptr) {
+        Utilities::log("[TaskProfiler] Not enough memory for task stats");
+        return;
+    }
+    RunTimeCounter totalRunTime = 0;
+    taskCount = uxTaskGetSystemState(tasks, taskCount, &totalRunTime);
+    uint32_t totalDelta = static_cast<uint32_t>(totalRunTime) - previousTotalRunTime;
+
+    // Run time is counted per core, so each core's tasks add up to 100%
+    for (UBaseType_t i = 0; i < taskCount; i++) {
+        uint32_t runTime = static_cast<uint32_t>(tasks[i].ulRunTimeCounter);
+        uint32_t previous = 0;
+        for (size_t j = 0; j < previousTaskCount; j++) {
+            if (previousTasks[j].handle == tasks[i].xHandle) {
+                previous = previousTasks[j].runTime;
+                break;
+            }
+        }
+        float share = totalDelta > 0 ? 100.0f * (runTime - previous) / totalDelta : 0.0f;
+        Utilities::log("[TaskProfiler]   " + String(tasks[i].pcTaskName)
+                       + " prio=" + String(tasks[i].uxCurrentPriority)
+                       + " cpu=" + String(share, 1) + "%"
+                       + " stackFree=" + String(tasks[i].usStackHighWaterMark));
+    }
+
+    previousTaskCount = std::min(static_cast<size_t>(taskCount), static_cast<size_t>(maxTrackedTasks));
+    for (size_t i = 0; i < previousTaskCount; i++) {
+        previousTasks[i].handle = tasks[i].xHandle;
+        previousTasks[i].runTime = static_cast<uint32_t>(tasks[i].ulRunTimeCounter);
+    }
+    previousTotalRunTime = static_cast<uint32_t>(totalRunTime);
+    free(tasks);
+#else
+    Utilities::log("[TaskProfiler] Per-task run-time stats unavailable: framework built without "
+                   "configGENERATE_RUN_TIME_STATS/configUSE_TRACE_FACILITY, see the busy shares above");
+#endif
+}
+
+#endif // RFID_PROFILING
@@ -3,20 +3,25 @@
 #include "Door.h"
 #include "Auth.h"
 #include "Utilities.h"
+#include "RefreshScheduler.h"
+#ifdef RFID_PROFILING
+#include "TaskProfiler.h"
+#include <esp_timer.h>
+#endif
 
 // WiFi credentials
 const char* ssid = "your-wifi-ssid";
 const char* password = "your-wifi-password";
 WiFiClient wifiClient;
 
-// Timing constants
-const long updateInterval = 300000;  // 5 minutes in milliseconds
-long lastCacheUpdateTime = 0;
+// Cache refresh timing: adaptive 2-30 minute interval, 1 hour staleness budget (see RefreshScheduler)
+RefreshScheduler refreshScheduler(esp_random);
 
 // Eastern Time Zone (EST/EDT)
 const long gmtOffset_sec = -5 * 3600; // GMT -5 hours for EST
 const int daylightOffset_sec = 3600;  // 1 hour for EDT
 void pollRFIDTask(void * parameter); // Forward declaration of the RFID polling task
+void doorTask(void * parameter); // Forward declaration of the door relock task
 
 SemaphoreHandle_t delaySemaphore;
 volatile int rfidTaskDelay = 10;
@@ -30,7 +35,12 @@ volatile int rfidTaskDelay = 10;
 void pollRFIDTask(void *parameter) {
     RFIDReader* rfidReader = RFIDReader::getInstance(wifiClient);
     for (;;) {
-        rfidReader->loop();
+        {
+#ifdef RFID_PROFILING
+            TaskProfiler::BusyScope busy(TaskProfiler::TrackedTask::PollRFID);
+#endif
+            rfidReader->loop();
+        }
         int currentDelay;
 
         // Safely get the current delay using semaphore for synchronization
@@ -43,7 +53,33 @@ void pollRFIDTask(void *parameter) {
         }
 
         // Delay the task for the specified time
-        vTaskDelay(currentDelay / portTICK_PERIOD_MS);
+        TickType_t delayTicks = currentDelay / portTICK_PERIOD_MS;
+#ifdef RFID_PROFILING
+        if (delayTicks > 0) {
+            // Same delay as vTaskDelay(delayTicks), but wakeTick ends up holding the exact tick it targets
+            TickType_t wakeTick = xTaskGetTickCount();
+            vTaskDelayUntil(&wakeTick, delayTicks);
+            TaskProfiler::getInstance()->recordWake(wakeTick, esp_timer_get_time());
+        } else {
+            vTaskDelay(delayTicks);
+        }
+#else
+        vTaskDelay(delayTicks);
+#endif
+    }
+}
+
+/**
+ * Task function for relocking the door.
+ * Runs Door::update() every 100 ms, independently of loop(), which can block for minutes in a
+ * cache refresh, and of pollRFIDTask, which backs off for up to a minute after denied swipes.
+ */
+void doorTask(void *parameter) {
+    Door* door = Door::getInstance();
+    TickType_t wakeTick = xTaskGetTickCount();
+    for (;;) {
+        door->update();
+        vTaskDelayUntil(&wakeTick, pdMS_TO_TICKS(100));
     }
 }
 
@@ -76,9 +112,34 @@ void initNTP() {
   }
 }
 
+/**
+ * Refresh the RFID cache and feed the outcome to the refresh scheduler.
+ * Logs sync outcome counters and cache age after every attempt.
+ */
+void refreshCache() {
+    Utilities::log("[Main] Updating RFID cache");
+    Auth::SyncResult result = Auth::getInstance(wifiClient)->fetchAndCacheRFIDData();
+    unsigned long now = millis();
+    if (result == Auth::SyncResult::Failed) {
+        refreshScheduler.recordFailure(now);
+    } else {
+        refreshScheduler.recordSuccess(now, result == Auth::SyncResult::Changed);
+    }
+
+    const RefreshScheduler::Metrics& metrics = refreshScheduler.getMetrics();
+    Utilities::log("[Main] Sync metrics: changed=" + String(metrics.changedSyncs)
+                   + " unchanged=" + String(metrics.unchangedSyncs)
+                   + " failed=" + String(metrics.failedSyncs)
+                   + " consecutiveFailures=" + String(metrics.consecutiveFailures)
+                   + " cacheAgeMs=" + String(refreshScheduler.cacheAge(now))
+                   + (refreshScheduler.isStale(now) ? " (stale)" : "")
+                   + " nextRefreshMs=" + String(refreshScheduler.getNextDelay()));
+}
+
 /**
  * Setup function for initial configuration.
- * Configures WiFi, NTP, and initializes Door, Auth, and RFIDReader singletons.
+ * Configures WiFi, NTP, initializes Door, Auth, and RFIDReader singletons, and starts
+ * pollRFIDTask and doorTask.
  */
 void setup() {
     Serial.begin(115200);
@@ -94,8 +155,14 @@ void setup() {
     // Initialize NTP for time synchronization
     initNTP();
 
+#ifdef RFID_PROFILING
+    // Created before pollRFIDTask so both cores see the same instance
+    TaskProfiler::getInstance();
+#endif
     Utilities::log("[Main] Initializing RFIDReader");
     RFIDReader::getInstance(wifiClient);
+    // Created before either task can unlock or relock it
+    Door::getInstance();
     Utilities::log("[Main] Initializing RFIDReaderTask, Door, and Auth objects");
     xTaskCreatePinnedToCore(
                 pollRFIDTask,   /* Task function. */
@@ -105,19 +172,24 @@ void setup() {
                 1,              /* priority of the task */
                 NULL,           /* Task handle to keep track of created task */
                 1);             /* pin task to core 1 */
-    
-    // Initial update for door status and RFID cache
-    Door::getInstance()->update();
-    Auth::getInstance(wifiClient)->fetchAndCacheRFIDData();
-    lastCacheUpdateTime = millis();
+    xTaskCreatePinnedToCore(
+                doorTask,       /* Task function. */
+                "doorTask",     /* name of task. */
+                4096,           /* Stack size of task */
+                NULL,           /* parameter of the task */
+                1,              /* priority of the task */
+                NULL,           /* Task handle to keep track of created task */
+                1);             /* pin task to core 1 */
+
+    // Initial RFID cache
+    refreshCache();
     Utilities::log("[Main] Setup complete");
 }
 
 /**
  * Main loop function.
- * Handles reconnection to WiFi and periodic cache updates on default CPU core 0.
- * Secondary CPU core (1) is already constantly polling (via setup() of pollRFIDTask)
- * Wiegand26 tag scans
+ * Handles reconnection to WiFi and periodic cache updates. Runs in the Arduino loopTask on core 1,
+ * alongside pollRFIDTask and doorTask; a pipelined refresh parses its pages on core 0.
  */
 void loop() {
   // Reconnect to WiFi if disconnected
@@ -130,15 +202,17 @@ void loop() {
       Utilities::log("[Main] WiFi Reconnected");
   }
 
-  // Periodically update the RFID cache and check door status
+  // Periodically update the RFID cache; doorTask relocks the door
   //Utilities::log("[Main] Loop start");
-  if (millis() - lastCacheUpdateTime >= updateInterval) {
-    Utilities::log("[Main] Checking Door is Locked");
-    Door::getInstance()->update();
-    Utilities::log("[Main] Updating RFID cache");
-    Auth::getInstance(wifiClient)->fetchAndCacheRFIDData();
-    lastCacheUpdateTime = millis(); // Reset the timer
+  if (refreshScheduler.isDue(millis())) {
+#ifdef RFID_PROFILING
+    TaskProfiler::BusyScope busy(TaskProfiler::TrackedTask::Loop);
+#endif
+    refreshCache();
   }
+#ifdef RFID_PROFILING
+  TaskProfiler::getInstance()->reportIfDue(millis());
+#endif
   delay(10);
   //Utilities::log("[Main] Loop end");
 }
\ No newline at end of file
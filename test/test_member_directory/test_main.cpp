@@ -0,0 +1,319 @@
+#include <unity.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "MemberDirectory.h"
+
+/**
+ * MemberDirectory::Builder staging and packing, plus the measured memory per member at 1k to 10k
+ * members. Builders that keep names use a maximum name length of 24.
+ */
+
+namespace {
+
+const char* const FirstNames[] = {
+    "Alex", "Bailey", "Cameron", "Dakota", "Elliot", "Finley", "Gray", "Harper", "Indigo", "Jordan",
+    "Kai", "Logan", "Morgan", "Noel", "Oakley", "Parker", "Quinn", "Riley", "Sage", "Taylor",
+    "Umber", "Val", "Wren", "Xen", "Yael", "Zion", "Avery", "Blair", "Casey", "Drew",
+    "Emery", "Frankie", "Gale", "Hayden", "Jesse", "Kendall", "Lee", "Marlowe", "Nico", "Robin"
+};
+const char* const LastNames[] = {
+    "Anderson", "Brown", "Clark", "Davis", "Evans", "Fischer", "Garcia", "Hughes", "Iyer", "Johnson",
+    "Kowalski", "Lopez", "Miller", "Nguyen", "Okafor", "Patel", "Quinlan", "Rossi", "Smith", "Thompson",
+    "Ueda", "Vasquez", "Walker", "Xu", "Young", "Zimmerman", "Baker", "Carter", "Dunn", "Ellis",
+    "Foster", "Grant", "Hill", "Irwin", "Jensen", "Kim", "Lambert", "Murphy", "Novak", "Owens"
+};
+constexpr size_t NameCount = sizeof(FirstNames) / sizeof(FirstNames[0]);
+constexpr size_t NameLength = 24;
+
+/**
+ * Unique display name for member i; past the first 1600 members last names are double-barrelled.
+ */
+std::string memberName(size_t i) {
+    std::string name = std::string(FirstNames[i % NameCount]) + " " + LastNames[(i / NameCount) % NameCount];
+    if (i >= NameCount * NameCount) {
+        name += std::string("-") + LastNames[(i / (NameCount * NameCount)) % NameCount];
+    }
+    return name;
+}
+
+} // namespace
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+void test_find_returns_members_by_tag() {
+    MemberDirectory::Builder builder(NameLength);
+    builder.begin(3);
+    TEST_ASSERT_TRUE(builder.add(300, 3, "Carol"));
+    TEST_ASSERT_TRUE(builder.add(100, 1, "Alice"));
+    TEST_ASSERT_TRUE(builder.add(200, 2, nullptr));
+    MemberDirectory directory;
+    TEST_ASSERT_TRUE(builder.build(directory));
+
+    TEST_ASSERT_EQUAL(3, directory.size());
+    TEST_ASSERT_EQUAL_UINT32(100, directory.getTagId(0));
+    TEST_ASSERT_EQUAL_UINT32(300, directory.getTagId(2));
+    size_t index = directory.find(300);
+    TEST_ASSERT_NOT_EQUAL(MemberDirectory::npos, index);
+    TEST_ASSERT_EQUAL_UINT32(3, directory.getContactId(index));
+    TEST_ASSERT_EQUAL_STRING("Carol", directory.getDisplayName(index));
+    TEST_ASSERT_EQUAL_STRING("", directory.getDisplayName(directory.find(200)));
+    TEST_ASSERT_EQUAL(MemberDirectory::npos, directory.find(150));
+    TEST_ASSERT_EQUAL(MemberDirectory::npos, directory.find(0));
+    TEST_ASSERT_EQUAL(MemberDirectory::npos, directory.find(400));
+}
+
+void test_duplicate_tag_keeps_lowest_contact_id() {
+    MemberDirectory::Builder builder(NameLength);
+    builder.begin(3);
+    TEST_ASSERT_TRUE(builder.add(100, 9, "Later"));
+    TEST_ASSERT_TRUE(builder.add(100, 4, "Earlier"));
+    TEST_ASSERT_TRUE(builder.add(100, 7, "Middle"));
+    MemberDirectory directory;
+    TEST_ASSERT_TRUE(builder.build(directory));
+
+    TEST_ASSERT_EQUAL(1, directory.size());
+    TEST_ASSERT_EQUAL_UINT32(4, directory.getContactId(0));
+    TEST_ASSERT_EQUAL_STRING("Earlier", directory.getDisplayName(0));
+}
+
+void test_zero_tags_are_ignored() {
+    MemberDirectory::Builder builder(NameLength);
+    builder.begin(2);
+    TEST_ASSERT_TRUE(builder.add(0, 1, "No Tag"));
+    TEST_ASSERT_TRUE(builder.add(5, 2, "Tagged"));
+    MemberDirectory directory;
+    TEST_ASSERT_TRUE(builder.build(directory));
+
+    TEST_ASSERT_EQUAL(1, directory.size());
+    TEST_ASSERT_EQUAL(MemberDirectory::npos, directory.find(0));
+}
+
+void test_identical_names_are_stored_once() {
+    MemberDirectory::Builder builder(NameLength);
+    builder.begin(2);
+    TEST_ASSERT_TRUE(builder.add(1, 1, "Sam Smith"));
+    TEST_ASSERT_TRUE(builder.add(2, 2, "Sam Smith"));
+    // Two members of three columns, the empty name and one copy of "Sam Smith" fit the staging block
+    TEST_ASSERT_EQUAL(0, builder.getBuildBytes());
+    MemberDirectory directory;
+    TEST_ASSERT_TRUE(builder.build(directory));
+
+    TEST_ASSERT_EQUAL_PTR(directory.getDisplayName(0), directory.getDisplayName(1));
+    TEST_ASSERT_EQUAL(2 * 12 + 1 + 10, directory.getArenaBytes());
+}
+
+void test_prefix_names_are_not_merged() {
+    MemberDirectory::Builder builder(NameLength);
+    builder.begin(2);
+    TEST_ASSERT_TRUE(builder.add(1, 1, "Sam Smith"));
+    TEST_ASSERT_TRUE(builder.add(2, 2, "Sam"));
+    MemberDirectory directory;
+    TEST_ASSERT_TRUE(builder.build(directory));
+
+    TEST_ASSERT_EQUAL_STRING("Sam Smith", directory.getDisplayName(0));
+    TEST_ASSERT_EQUAL_STRING("Sam", directory.getDisplayName(1));
+}
+
+void test_long_names_are_truncated_on_utf8_boundaries() {
+    MemberDirectory::Builder builder(NameLength);
+    builder.begin(2);
+    // 23 ASCII bytes followed by a two-byte e-acute that would straddle the 24 byte limit
+    TEST_ASSERT_TRUE(builder.add(1, 1, "Abcdefghijklmnopqrstuvw\xC3\xA9 Long"));
+    TEST_ASSERT_TRUE(builder.add(2, 2, "Abcdefghijklmnopqrstuvwxyz"));
+    MemberDirectory directory;
+    TEST_ASSERT_TRUE(builder.build(directory));
+
+    TEST_ASSERT_EQUAL_STRING("Abcdefghijklmnopqrstuvw", directory.getDisplayName(0));
+    TEST_ASSERT_EQUAL_STRING("Abcdefghijklmnopqrstuvwx", directory.getDisplayName(1));
+}
+
+void test_add_fails_past_expected_members() {
+    MemberDirectory::Builder builder(NameLength);
+    builder.begin(0);
+    // begin() leaves slack for contacts added during the sync, but not without bound
+    uint32_t added = 0;
+    while (builder.add(added + 1, added + 1, "Member") && added < 1000) {
+        added++;
+    }
+    TEST_ASSERT_GREATER_THAN(0, added);
+    TEST_ASSERT_LESS_THAN(1000, added);
+    TEST_ASSERT_FALSE(builder.add(5000, 5000, "One Too Many"));
+    TEST_ASSERT_FALSE(builder.isOutOfMemory());
+}
+
+void test_add_without_begin_fails() {
+    MemberDirectory::Builder builder(NameLength);
+    TEST_ASSERT_FALSE(builder.add(1, 1, "Not Begun"));
+    TEST_ASSERT_EQUAL(0, builder.getStagingBytes());
+}
+
+void test_build_without_members_gives_empty_directory() {
+    MemberDirectory::Builder builder(NameLength);
+    MemberDirectory directory;
+    TEST_ASSERT_TRUE(builder.build(directory));
+    TEST_ASSERT_EQUAL(0, directory.size());
+    TEST_ASSERT_EQUAL(0, directory.getArenaBytes());
+    TEST_ASSERT_EQUAL(MemberDirectory::npos, directory.find(1));
+}
+
+void test_build_and_clear_free_staging() {
+    MemberDirectory::Builder builder(NameLength);
+    builder.begin(100);
+    TEST_ASSERT_EQUAL(0, builder.getStagingBytes());
+    TEST_ASSERT_TRUE(builder.add(1, 1, "Member"));
+    TEST_ASSERT_GREATER_THAN(0, builder.getStagingBytes());
+    builder.clear();
+    TEST_ASSERT_EQUAL(0, builder.getStagingBytes());
+    TEST_ASSERT_FALSE(builder.add(2, 2, "After Clear"));
+
+    builder.begin(100);
+    TEST_ASSERT_TRUE(builder.add(1, 1, "Member"));
+    MemberDirectory directory;
+    TEST_ASSERT_TRUE(builder.build(directory));
+    TEST_ASSERT_EQUAL(0, builder.getStagingBytes());
+    TEST_ASSERT_EQUAL(1, directory.size());
+}
+
+void test_staging_grows_past_first_chunk() {
+    MemberDirectory::Builder builder(NameLength);
+    builder.begin(1000);
+    char name[NameLength + 1];
+    for (uint32_t i = 0; i < 1000; i++) {
+        // 24 byte names, past the first name pool, and more members than the first staging block
+        snprintf(name, sizeof(name), "Member %017u", static_cast<unsigned>(i));
+        TEST_ASSERT_TRUE(builder.add(1000 - i, i + 1, name));
+    }
+    TEST_ASSERT_EQUAL(0, builder.getDroppedNames());
+    MemberDirectory directory;
+    TEST_ASSERT_TRUE(builder.build(directory));
+    TEST_ASSERT_EQUAL(1000, directory.size());
+    TEST_ASSERT_EQUAL_UINT32(1000, directory.getContactId(directory.find(1)));
+    TEST_ASSERT_EQUAL_STRING("Member 00000000000000999", directory.getDisplayName(directory.find(1)));
+}
+
+void test_without_names_only_ids_are_kept() {
+    MemberDirectory::Builder builder(0);
+    TEST_ASSERT_FALSE(builder.keepsNames());
+    builder.begin(2);
+    TEST_ASSERT_TRUE(builder.add(2, 20, "Bob"));
+    TEST_ASSERT_TRUE(builder.add(1, 10, "Alice"));
+    MemberDirectory directory;
+    TEST_ASSERT_TRUE(builder.build(directory));
+
+    TEST_ASSERT_EQUAL(2, directory.size());
+    TEST_ASSERT_EQUAL_UINT32(10, directory.getContactId(directory.find(1)));
+    TEST_ASSERT_EQUAL_STRING("", directory.getDisplayName(directory.find(2)));
+    // Two 4 byte columns and nothing else
+    TEST_ASSERT_EQUAL(2 * 8, directory.getArenaBytes());
+}
+
+void test_rebuilt_directory_compares_equal() {
+    MemberDirectory first;
+    MemberDirectory second;
+    MemberDirectory::Builder builder(NameLength);
+    builder.begin(2);
+    builder.add(1, 1, "Alice");
+    builder.add(2, 2, "Bob");
+    TEST_ASSERT_TRUE(builder.build(first));
+    builder.begin(2);
+    builder.add(2, 2, "Bob");
+    builder.add(1, 1, "Alice");
+    TEST_ASSERT_TRUE(builder.build(second));
+    TEST_ASSERT_TRUE(first.sameMembers(second));
+
+    builder.begin(2);
+    builder.add(1, 1, "Alice");
+    builder.add(2, 2, "Robert");
+    TEST_ASSERT_TRUE(builder.build(second));
+    TEST_ASSERT_FALSE(first.sameMembers(second));
+    // A rename or a tag moved to another contact leaves the tag set, and so the flash cache, as it was
+    TEST_ASSERT_TRUE(first.sameTags(second));
+
+    builder.begin(2);
+    builder.add(1, 1, "Alice");
+    builder.add(2, 3, "Carol");
+    TEST_ASSERT_TRUE(builder.build(second));
+    TEST_ASSERT_TRUE(first.sameTags(second));
+
+    builder.begin(2);
+    builder.add(1, 1, "Alice");
+    builder.add(3, 2, "Bob");
+    TEST_ASSERT_TRUE(builder.build(second));
+    TEST_ASSERT_FALSE(first.sameTags(second));
+
+    builder.begin(1);
+    builder.add(1, 1, "Alice");
+    TEST_ASSERT_TRUE(builder.build(second));
+    TEST_ASSERT_FALSE(first.sameTags(second));
+    TEST_ASSERT_TRUE(MemberDirectory().sameTags(MemberDirectory()));
+}
+
+/**
+ * Arena and peak staging bytes per member with unique names, every contact tagged, without and with
+ * names. Staging grows with the members added; begin() only bounds it, as with the contact count in a
+ * sync. The sync peak holds the old arena and the staging, since build() reuses the staging block.
+ */
+void test_bytes_per_member() {
+    const size_t memberCounts[] = {1000, 2000, 5000, 10000};
+    const size_t nameLengths[] = {0, NameLength};
+    for (size_t nameLength : nameLengths) {
+        for (size_t members : memberCounts) {
+            MemberDirectory::Builder builder(nameLength);
+            builder.begin(members);
+            for (size_t i = 0; i < members; i++) {
+                TEST_ASSERT_TRUE(builder.add(static_cast<uint32_t>(1000000 + i * 13),
+                                             static_cast<uint32_t>(50000000 + i), memberName(i).c_str()));
+            }
+            size_t stagingBytes = builder.getStagingBytes();
+            size_t buildBytes = builder.getBuildBytes();
+            MemberDirectory directory;
+            TEST_ASSERT_TRUE(builder.build(directory));
+            TEST_ASSERT_EQUAL(members, directory.size());
+            size_t last = directory.find(1000000 + (members - 1) * 13);
+            TEST_ASSERT_EQUAL_STRING(nameLength > 0 ? memberName(members - 1).c_str() : "",
+                                     directory.getDisplayName(last));
+
+            char message[200];
+            snprintf(message, sizeof(message),
+                     "names %2zu, %5zu members: arena %6zu bytes (%.1f/member), staging %6zu bytes "
+                     "(%.1f/member), build %6zu bytes, sync peak %6zu bytes",
+                     nameLength, members, directory.getArenaBytes(), double(directory.getArenaBytes()) / members,
+                     stagingBytes, double(stagingBytes) / members, buildBytes,
+                     directory.getArenaBytes() + std::max(stagingBytes, buildBytes + stagingBytes));
+            TEST_MESSAGE(message);
+            if (nameLength == 0) {
+                // Two 4 byte columns, and staging at most a quarter larger while it grows
+                TEST_ASSERT_EQUAL(members * 8, directory.getArenaBytes());
+                TEST_ASSERT_LESS_OR_EQUAL(members * 10 + 2048, stagingBytes);
+            } else {
+                // Three 4 byte columns plus at most 25 bytes of name per member
+                TEST_ASSERT_LESS_OR_EQUAL(members * 37 + 1, directory.getArenaBytes());
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_find_returns_members_by_tag);
+    RUN_TEST(test_duplicate_tag_keeps_lowest_contact_id);
+    RUN_TEST(test_zero_tags_are_ignored);
+    RUN_TEST(test_identical_names_are_stored_once);
+    RUN_TEST(test_prefix_names_are_not_merged);
+    RUN_TEST(test_long_names_are_truncated_on_utf8_boundaries);
+    RUN_TEST(test_add_fails_past_expected_members);
+    RUN_TEST(test_add_without_begin_fails);
+    RUN_TEST(test_build_without_members_gives_empty_directory);
+    RUN_TEST(test_build_and_clear_free_staging);
+    RUN_TEST(test_staging_grows_past_first_chunk);
+    RUN_TEST(test_without_names_only_ids_are_kept);
+    RUN_TEST(test_rebuilt_directory_compares_equal);
+    RUN_TEST(test_bytes_per_member);
+    return UNITY_END();
+}
@@ -0,0 +1,277 @@
+#include <unity.h>
+#include <climits>
+#include "RefreshScheduler.h"
+
+/**
+ * RefreshScheduler on a virtual clock: interval adaptation, jitter bounds, failure backoff, the
+ * staleness budget and boot-time failures. Times are in milliseconds; the defaults are a 5 minute
+ * base interval, 2-30 minute range, 15 s first backoff capped at 10 minutes, 1 hour staleness
+ * budget and 30 s urgent retry.
+ */
+
+namespace {
+
+uint32_t randomState = 1;
+
+uint32_t seededRandom() {
+    // Numerical Recipes LCG; the upper bits are the most random
+    randomState = randomState * 1664525u + 1013904223u;
+    return randomState >> 8;
+}
+
+uint32_t zeroRandom() {
+    return 0;
+}
+
+const unsigned long minute = 60000;
+
+}  // namespace
+
+void setUp(void) {
+    randomState = 1;
+}
+
+void tearDown(void) {}
+
+void test_refresh_is_due_at_boot(void) {
+    RefreshScheduler scheduler(seededRandom);
+    TEST_ASSERT_TRUE(scheduler.isDue(0));
+    TEST_ASSERT_EQUAL_UINT32(5 * minute, scheduler.getInterval());
+}
+
+void test_unchanged_syncs_grow_interval_up_to_max(void) {
+    RefreshScheduler scheduler(zeroRandom);
+    unsigned long now = 0;
+    unsigned long expected = 5 * minute;
+    for (int i = 0; i < 10; i++) {
+        scheduler.recordSuccess(now, false);
+        expected = std::min(expected + expected / 2, 30 * minute);
+        TEST_ASSERT_EQUAL_UINT32(expected, scheduler.getInterval());
+        now += scheduler.getNextDelay();
+    }
+    TEST_ASSERT_EQUAL_UINT32(30 * minute, scheduler.getInterval());
+    TEST_ASSERT_EQUAL_UINT32(10, scheduler.getMetrics().unchangedSyncs);
+}
+
+void test_changed_syncs_shrink_interval_down_to_min(void) {
+    RefreshScheduler scheduler(zeroRandom, 30 * minute);
+    unsigned long now = 0;
+    scheduler.recordSuccess(now, true);
+    TEST_ASSERT_EQUAL_UINT32(15 * minute, scheduler.getInterval());
+    for (int i = 0; i < 10; i++) {
+        now += scheduler.getNextDelay();
+        scheduler.recordSuccess(now, true);
+    }
+    TEST_ASSERT_EQUAL_UINT32(2 * minute, scheduler.getInterval());
+    TEST_ASSERT_EQUAL_UINT32(11, scheduler.getMetrics().changedSyncs);
+}
+
+void test_success_jitter_stays_within_ten_percent(void) {
+    RefreshScheduler scheduler(seededRandom, 2 * minute);
+    unsigned long now = 0;
+    unsigned long shortest = ULONG_MAX;
+    unsigned long longest = 0;
+    for (int i = 0; i < 2000; i++) {
+        // Changed syncs keep the interval pinned at the 2 minute minimum
+        scheduler.recordSuccess(now, true);
+        unsigned long delay = scheduler.getNextDelay();
+        TEST_ASSERT_GREATER_OR_EQUAL(108000, delay);
+        TEST_ASSERT_LESS_OR_EQUAL(132000, delay);
+        shortest = std::min(shortest, delay);
+        longest = std::max(longest, delay);
+        now += delay;
+    }
+    // The jitter actually spreads refreshes over most of the window
+    TEST_ASSERT_LESS_THAN(110000, shortest);
+    TEST_ASSERT_GREATER_THAN(130000, longest);
+}
+
+void test_refresh_becomes_due_after_delay(void) {
+    RefreshScheduler scheduler(seededRandom);
+    scheduler.recordSuccess(1000, false);
+    unsigned long delay = scheduler.getNextDelay();
+    TEST_ASSERT_FALSE(scheduler.isDue(1000));
+    TEST_ASSERT_FALSE(scheduler.isDue(1000 + delay - 1));
+    TEST_ASSERT_TRUE(scheduler.isDue(1000 + delay));
+}
+
+void test_failures_back_off_exponentially_to_cap(void) {
+    RefreshScheduler scheduler(zeroRandom);
+    unsigned long now = 0;
+    // Succeed first: before any success every failure is retried urgently
+    scheduler.recordSuccess(now, false);
+    // Equal jitter with a zero random source waits exactly half the backoff
+    const unsigned long expected[] = {7500, 15000, 30000, 60000, 120000, 240000, 300000, 300000};
+    for (unsigned long delay : expected) {
+        scheduler.recordFailure(now);
+        TEST_ASSERT_EQUAL_UINT32(delay, scheduler.getNextDelay());
+        now += scheduler.getNextDelay();
+    }
+    TEST_ASSERT_EQUAL_UINT32(8, scheduler.getMetrics().consecutiveFailures);
+}
+
+void test_failure_jitter_stays_within_backoff(void) {
+    for (unsigned int failures = 1; failures <= 8; failures++) {
+        unsigned long backoff = std::min(15000UL << (failures - 1), 10 * minute);
+        for (int run = 0; run < 200; run++) {
+            RefreshScheduler scheduler(seededRandom, 5 * minute, 2 * minute, 30 * minute, 15000, 10 * minute,
+                                       24 * 60 * minute);
+            // Succeed first so the staleness budget is far away and does not clamp the backoff
+            scheduler.recordSuccess(0, false);
+            for (unsigned int i = 0; i < failures; i++) {
+                scheduler.recordFailure(1000);
+            }
+            TEST_ASSERT_GREATER_OR_EQUAL(backoff / 2, scheduler.getNextDelay());
+            TEST_ASSERT_LESS_OR_EQUAL(backoff, scheduler.getNextDelay());
+        }
+    }
+}
+
+void test_many_failures_do_not_overflow_backoff(void) {
+    RefreshScheduler scheduler(seededRandom, 5 * minute, 2 * minute, 30 * minute, 15000, 10 * minute,
+                               24 * 60 * minute);
+    scheduler.recordSuccess(0, false);
+    for (int i = 0; i < 100; i++) {
+        scheduler.recordFailure(1000);
+        TEST_ASSERT_GREATER_OR_EQUAL(7500, scheduler.getNextDelay());
+        TEST_ASSERT_LESS_OR_EQUAL(10 * minute, scheduler.getNextDelay());
+    }
+}
+
+void test_success_resets_backoff(void) {
+    RefreshScheduler scheduler(zeroRandom);
+    for (int i = 0; i < 5; i++) {
+        scheduler.recordFailure(0);
+    }
+    scheduler.recordSuccess(0, false);
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.getMetrics().consecutiveFailures);
+    scheduler.recordFailure(0);
+    TEST_ASSERT_EQUAL_UINT32(7500, scheduler.getNextDelay());
+    TEST_ASSERT_EQUAL_UINT32(6, scheduler.getMetrics().failedSyncs);
+}
+
+void test_backoff_never_sleeps_past_staleness_budget(void) {
+    RefreshScheduler scheduler(seededRandom);
+    scheduler.recordSuccess(0, false);
+    // Fail 55 minutes later: a 10 minute backoff would leave the cache 65 minutes old
+    unsigned long now = 55 * minute;
+    for (int i = 0; i < 8; i++) {
+        scheduler.recordFailure(now);
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(5 * minute, scheduler.getNextDelay());
+    TEST_ASSERT_FALSE(scheduler.isStale(now + scheduler.getNextDelay()));
+}
+
+void test_stale_cache_retries_urgently(void) {
+    RefreshScheduler scheduler(seededRandom);
+    scheduler.recordSuccess(0, false);
+    unsigned long now = 61 * minute;
+    TEST_ASSERT_TRUE(scheduler.isStale(now));
+    for (int i = 0; i < 20; i++) {
+        scheduler.recordFailure(now);
+        TEST_ASSERT_LESS_OR_EQUAL(30000, scheduler.getNextDelay());
+        now += scheduler.getNextDelay();
+    }
+    scheduler.recordSuccess(now, true);
+    TEST_ASSERT_FALSE(scheduler.isStale(now));
+}
+
+void test_cache_is_stale_until_first_success(void) {
+    // There is no cache before the first success, so every member is denied however young it is
+    RefreshScheduler scheduler(seededRandom);
+    TEST_ASSERT_EQUAL_UINT32(10 * minute, scheduler.cacheAge(10 * minute));
+    TEST_ASSERT_TRUE(scheduler.isStale(0));
+    TEST_ASSERT_TRUE(scheduler.isStale(10 * minute));
+    scheduler.recordSuccess(10 * minute, false);
+    TEST_ASSERT_FALSE(scheduler.isStale(10 * minute));
+}
+
+void test_boot_failures_retry_urgently_on_virtual_clock(void) {
+    // WildApricot unreachable for the first 20 minutes after boot
+    RefreshScheduler scheduler(seededRandom);
+    unsigned long now = 0;
+    unsigned long outageEnd = 20 * minute;
+    unsigned long attemptsDuringOutage = 0;
+    while (now < outageEnd) {
+        TEST_ASSERT_TRUE(scheduler.isDue(now));
+        scheduler.recordFailure(now);
+        attemptsDuringOutage++;
+        // Never backs off past the urgent retry while members are locked out
+        TEST_ASSERT_LESS_OR_EQUAL(30000, scheduler.getNextDelay());
+        now += scheduler.getNextDelay();
+    }
+    // The first sync after the outage lands within one urgent retry
+    TEST_ASSERT_LESS_OR_EQUAL(outageEnd + 30000, now);
+    scheduler.recordSuccess(now, true);
+    TEST_ASSERT_FALSE(scheduler.isStale(now));
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.getMetrics().consecutiveFailures);
+    // Backoff ramps up to the urgent retry: no retry every few seconds either
+    TEST_ASSERT_GREATER_THAN(30, attemptsDuringOutage);
+    TEST_ASSERT_LESS_THAN(100, attemptsDuringOutage);
+}
+
+void test_outage_retries_urgently_once_stale_on_virtual_clock(void) {
+    // A 3 hour outage: backoff until the budget runs out, then urgent retries, then recovery
+    RefreshScheduler scheduler(seededRandom);
+    unsigned long now = 0;
+    unsigned long outageStart = 2 * 60 * minute;
+    unsigned long outageEnd = 5 * 60 * minute;
+    unsigned long attemptsDuringOutage = 0;
+    unsigned long firstStaleAttempt = 0;
+    unsigned long firstSuccessAfterOutage = 0;
+    unsigned long lastSuccessBeforeOutage = 0;
+    while (now < 8 * 60 * minute) {
+        TEST_ASSERT_TRUE(scheduler.isDue(now));
+        if (now >= outageStart && now < outageEnd) {
+            if (firstStaleAttempt == 0 && scheduler.isStale(now)) {
+                firstStaleAttempt = now;
+            }
+            scheduler.recordFailure(now);
+            attemptsDuringOutage++;
+        } else {
+            if (now < outageStart) {
+                lastSuccessBeforeOutage = now;
+            } else if (firstSuccessAfterOutage == 0) {
+                firstSuccessAfterOutage = now;
+            }
+            scheduler.recordSuccess(now, false);
+        }
+        now += scheduler.getNextDelay();
+    }
+    // The budget is overrun by at most one urgent retry, and recovery is noticed just as quickly
+    TEST_ASSERT_TRUE(firstStaleAttempt != 0);
+    TEST_ASSERT_LESS_OR_EQUAL(60 * minute + 30000, firstStaleAttempt - lastSuccessBeforeOutage);
+    TEST_ASSERT_LESS_OR_EQUAL(outageEnd + 30000, firstSuccessAfterOutage);
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler.getMetrics().consecutiveFailures);
+    // Backoff first, then one attempt per urgent retry: not a retry every few seconds
+    TEST_ASSERT_LESS_THAN(400, attemptsDuringOutage);
+    TEST_ASSERT_GREATER_THAN(100, attemptsDuringOutage);
+}
+
+void test_schedule_survives_millis_overflow(void) {
+    RefreshScheduler scheduler(zeroRandom);
+    unsigned long now = ULONG_MAX - 1000;
+    scheduler.recordFailure(now);
+    TEST_ASSERT_FALSE(scheduler.isDue(now + 5000));
+    TEST_ASSERT_TRUE(scheduler.isDue(now + 7500));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_refresh_is_due_at_boot);
+    RUN_TEST(test_unchanged_syncs_grow_interval_up_to_max);
+    RUN_TEST(test_changed_syncs_shrink_interval_down_to_min);
+    RUN_TEST(test_success_jitter_stays_within_ten_percent);
+    RUN_TEST(test_refresh_becomes_due_after_delay);
+    RUN_TEST(test_failures_back_off_exponentially_to_cap);
+    RUN_TEST(test_failure_jitter_stays_within_backoff);
+    RUN_TEST(test_many_failures_do_not_overflow_backoff);
+    RUN_TEST(test_success_resets_backoff);
+    RUN_TEST(test_backoff_never_sleeps_past_staleness_budget);
+    RUN_TEST(test_stale_cache_retries_urgently);
+    RUN_TEST(test_cache_is_stale_until_first_success);
+    RUN_TEST(test_boot_failures_retry_urgently_on_virtual_clock);
+    RUN_TEST(test_outage_retries_urgently_once_stale_on_virtual_clock);
+    RUN_TEST(test_schedule_survives_millis_overflow);
+    return UNITY_END();
+}
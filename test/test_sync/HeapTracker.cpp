@@ -0,0 +1,104 @@
+#include "HeapTracker.h"
+#include <atomic>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void __libc_free(void* pointer);
+}
+
+namespace {
+
+std::atomic<size_t> currentBytes{0};
+std::atomic<size_t> peakBytes{0};
+thread_local bool ignoredThread = false;
+
+void allocated(void* pointer) {
+    if (pointer == nullptr || ignoredThread) {
+        return;
+    }
+    size_t current = currentBytes += malloc_usable_size(pointer);
+    size_t peak = peakBytes.load();
+    while (current > peak && !peakBytes.compare_exchange_weak(peak, current)) {
+    }
+}
+
+void released(void* pointer) {
+    if (pointer != nullptr && !ignoredThread) {
+        currentBytes -= malloc_usable_size(pointer);
+    }
+}
+
+}  // namespace
+
+extern "C" {
+
+void* malloc(size_t size) {
+    void* pointer = __libc_malloc(size);
+    allocated(pointer);
+    return pointer;
+}
+
+void* calloc(size_t count, size_t size) {
+    void* pointer = __libc_calloc(count, size);
+    allocated(pointer);
+    return pointer;
+}
+
+void* realloc(void* pointer, size_t size) {
+    released(pointer);
+    void* resized = __libc_realloc(pointer, size);
+    allocated(resized != nullptr || size == 0 ? resized : pointer);
+    return resized;
+}
+
+void free(void* pointer) {
+    released(pointer);
+    __libc_free(pointer);
+}
+
+}  // extern "C"
+
+bool HeapTracker::isAvailable() {
+    return true;
+}
+
+void HeapTracker::resetPeak() {
+    peakBytes = currentBytes.load();
+}
+
+size_t HeapTracker::getCurrentBytes() {
+    return currentBytes;
+}
+
+size_t HeapTracker::getPeakBytes() {
+    return peakBytes;
+}
+
+void HeapTracker::ignoreCurrentThread() {
+    ignoredThread = true;
+}
+
+#else
+
+bool HeapTracker::isAvailable() {
+    return false;
+}
+
+void HeapTracker::resetPeak() {}
+
+size_t HeapTracker::getCurrentBytes() {
+    return 0;
+}
+
+size_t HeapTracker::getPeakBytes() {
+    return 0;
+}
+
+void HeapTracker::ignoreCurrentThread() {}
+
+#endif
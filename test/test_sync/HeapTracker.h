@@ -0,0 +1,40 @@
+#ifndef HEAP_TRACKER_H
+#define HEAP_TRACKER_H
+
+#include <cstddef>
+
+/**
+ * @brief Counts live heap bytes of the test process, so a sync's peak memory can be reported.
+ *
+ * Wraps malloc/free on glibc; elsewhere isAvailable() is false and every reading is 0.
+ * Threads that call ignoreCurrentThread() (the replay server) are left out of the count.
+ */
+class HeapTracker {
+public:
+    /**
+     * @return True if allocations are being counted on this platform.
+     */
+    static bool isAvailable();
+
+    /**
+     * Starts a new measurement: the peak is reset to the current usage.
+     */
+    static void resetPeak();
+
+    /**
+     * @return Live heap bytes.
+     */
+    static size_t getCurrentBytes();
+
+    /**
+     * @return Highest live heap bytes since the last resetPeak().
+     */
+    static size_t getPeakBytes();
+
+    /**
+     * Stops counting allocations made by the calling thread.
+     */
+    static void ignoreCurrentThread();
+};
+
+#endif // HEAP_TRACKER_H
@@ -0,0 +1,255 @@
+#include "HostSyncClient.h"
+#include "HeapTracker.h"
+#include "MockWildApricot.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdlib>
+
+namespace {
+
+std::string syncLog;
+size_t freeBlockLimit = SIZE_MAX;
+
+void logLine(const char* message) {
+    syncLog += message;
+    syncLog += '\n';
+}
+
+size_t largestFreeBlock() {
+    return freeBlockLimit;
+}
+
+}  // namespace
+
+/**
+ * Host counterpart of PagePipeline: a buffer pool and two bounded queues, created per run, feeding a
+ * parser thread. The network stage blocks in acquire() when it is poolSize pages ahead of the parser.
+ */
+class HostSyncClient::ParserThread : public PageSink {
+public:
+    ParserThread(size_t bufferSize, size_t poolSize) : bufferSize(bufferSize), poolSize(poolSize) {}
+
+    ~ParserThread() override {
+        freeRun();
+    }
+
+    bool begin(PageParser parser, void* context) override {
+        this->parser = parser;
+        this->context = context;
+        runOk = true;
+        endOfRun = false;
+        pool.resize(poolSize);
+        for (PageBuffer& page : pool) {
+            page.data = static_cast<char*>(malloc(bufferSize));
+            if (page.data == nullptr) {
+                freeRun();
+                return false;
+            }
+            page.capacity = bufferSize;
+            freePages.push_back(&page);
+        }
+        worker = std::thread(&ParserThread::run, this);
+        return true;
+    }
+
+    PageBuffer* acquire() override {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this] { return !freePages.empty(); });
+        PageBuffer* page = freePages.front();
+        freePages.pop_front();
+        page->length = 0;
+        return page;
+    }
+
+    void submit(PageBuffer* page) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        filledPages.push_back(page);
+        changed.notify_all();
+    }
+
+    void release(PageBuffer* page) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        freePages.push_back(page);
+        changed.notify_all();
+    }
+
+    bool failed() const override {
+        return !runOk;
+    }
+
+    bool finish() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            endOfRun = true;
+            changed.notify_all();
+        }
+        worker.join();
+        freeRun();
+        return runOk;
+    }
+
+private:
+    const size_t bufferSize;
+    const size_t poolSize;
+    PageParser parser = nullptr;
+    void* context = nullptr;
+    std::vector<PageBuffer> pool;
+    std::deque<PageBuffer*> freePages;
+    std::deque<PageBuffer*> filledPages;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::thread worker;
+    bool endOfRun = false;
+    std::atomic<bool> runOk{true};  ///< Cleared by the parser thread, read by the network stage.
+
+    void freeRun() {
+        for (PageBuffer& page : pool) {
+            free(page.data);
+        }
+        pool.clear();
+        pool.shrink_to_fit();
+        freePages.clear();
+        filledPages.clear();
+    }
+
+    void run() {
+        for (;;) {
+            PageBuffer* page;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [this] { return !filledPages.empty() || endOfRun; });
+                if (filledPages.empty()) {
+                    return;
+                }
+                page = filledPages.front();
+                filledPages.pop_front();
+            }
+            // After a failure the rest of the run is only drained, not parsed
+            if (runOk && !parser(*page, context)) {
+                runOk = false;
+            }
+            release(page);
+        }
+    }
+};
+
+/**
+ * Wraps another PageSink to time the firmware's page parser, and to slow it down to emulate a slower CPU.
+ */
+class HostSyncClient::TimedParser : public PageSink {
+public:
+    TimedParser(PageSink& sink, uint32_t slowdown) : sink(sink), slowdown(slowdown) {}
+
+    bool begin(PageParser parser, void* context) override {
+        this->parser = parser;
+        this->context = context;
+        return sink.begin(parse, this);
+    }
+
+    PageBuffer* acquire() override {
+        return sink.acquire();
+    }
+
+    void submit(PageBuffer* page) override {
+        sink.submit(page);
+    }
+
+    void release(PageBuffer* page) override {
+        sink.release(page);
+    }
+
+    bool failed() const override {
+        return sink.failed();
+    }
+
+    bool finish() override {
+        return sink.finish();
+    }
+
+    /**
+     * @return Time spent parsing, slowdown included. Read after finish().
+     */
+    double getParseMs() const {
+        return parseMs;
+    }
+
+private:
+    PageSink& sink;
+    const uint32_t slowdown;
+    PageParser parser = nullptr;
+    void* context = nullptr;
+    double parseMs = 0;
+
+    static bool parse(PageBuffer& page, void* context) {
+        TimedParser* timed = static_cast<TimedParser*>(context);
+        auto start = std::chrono::steady_clock::now();
+        bool ok = timed->parser(page, timed->context);
+        auto parsed = std::chrono::steady_clock::now();
+        if (timed->slowdown > 1) {
+            auto until = parsed + (parsed - start) * (timed->slowdown - 1);
+            while (std::chrono::steady_clock::now() < until) {
+            }
+        }
+        timed->parseMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return ok;
+    }
+};
+
+HostSyncClient::HostSyncClient(uint16_t port, const Options& options)
+    : options(options),
+      transport(port, options.responseTimeoutMs),
+      contactsSync(transport, syncConfig(options), logLine, largestFreeBlock) {}
+
+ContactsSync::Config HostSyncClient::syncConfig(const Options& options) {
+    ContactsSync::Config config;
+    config.tokenAuthorization = "Basic QVBJS0VZOm1vY2s=";
+    config.contactsPath = MockWildApricot::contactsPath;
+    config.pageSize = options.pageSize;
+    config.selectFields = options.selectFields;
+    config.maxNameLength = options.maxNameLength;
+    return config;
+}
+
+const HostSyncClient::Stats& HostSyncClient::getStats() const {
+    return stats;
+}
+
+const std::string& HostSyncClient::getLog() {
+    return syncLog;
+}
+
+bool HostSyncClient::sync(MemberDirectory& directory) {
+    stats = Stats();
+    syncLog.clear();
+    freeBlockLimit = options.largestFreeBlock;
+    HeapTracker::resetPeak();
+    size_t heapAtStart = HeapTracker::getCurrentBytes();
+    auto start = std::chrono::steady_clock::now();
+
+    bool ok;
+    if (options.pipelined) {
+        ParserThread pipeline(options.pageBufferSize, options.poolSize);
+        TimedParser timed(pipeline, options.parseSlowdown);
+        ok = contactsSync.sync(timed, directory);
+        stats.parseMs = timed.getParseMs();
+    } else {
+        SerialPageSink serial(options.pageBufferSize);
+        TimedParser timed(serial, options.parseSlowdown);
+        ok = contactsSync.sync(timed, directory);
+        stats.parseMs = timed.getParseMs();
+    }
+
+    stats.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stats.peakHeapBytes = HeapTracker::getPeakBytes() - heapAtStart;
+    const ContactsSync::Stats& syncStats = contactsSync.getStats();
+    stats.httpCode = syncStats.httpCode;
+    stats.requests = syncStats.requests;
+    stats.pages = syncStats.pages;
+    stats.bodyBytes = syncStats.bodyBytes;
+    return ok;
+}
@@ -0,0 +1,84 @@
+#ifndef HOST_SYNC_CLIENT_H
+#define HOST_SYNC_CLIENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "ContactsSync.h"
+#include "PosixTransport.h"
+
+/**
+ * @brief Runs the firmware's ContactsSync against MockWildApricot and measures it.
+ *
+ * The sync sequence (token, count, pages, truncation checks, 401 retry, memory check and directory
+ * build) is ContactsSync itself; only the transport and the parser thread are host stand-ins.
+ * Requests go through PosixTransport. Pages are either parsed right after each download by the
+ * firmware's SerialPageSink (AUTH_SERIAL_SYNC on the device) or handed to a parser thread through a
+ * recycled buffer pool, with the same PageSink protocol as PagePipeline, so the two modes can be
+ * compared against the same server.
+ */
+class HostSyncClient {
+public:
+    /**
+     * Sync parameters, mirroring the constants in Auth.
+     */
+    struct Options {
+        size_t pageBufferSize = CONTACTS_PAGE_BUFFER_SIZE; ///< Bytes per page buffer; larger pages fail the sync.
+        uint32_t pageSize = ContactsParser::contactsPerPage(CONTACTS_PAGE_BUFFER_SIZE); ///< Contacts per page.
+        bool selectFields = true;  ///< Append ContactsParser::selectQuery to page requests.
+        size_t maxNameLength = MEMBER_NAME_MAX_LENGTH; ///< Longest display name kept; 0 keeps contact IDs only.
+        bool pipelined = false;    ///< Parse on a separate thread while the next page downloads.
+        size_t poolSize = 3;       ///< Page buffers in pipelined mode, as Auth::pagePoolSize.
+        uint32_t parseSlowdown = 1; ///< Busy-waits so parsing takes this many times longer, to emulate a slower CPU.
+        size_t largestFreeBlock = SIZE_MAX; ///< Reported by the free heap probe, to exercise the memory check.
+        uint32_t responseTimeoutMs = 5000;  ///< Transport timeout.
+    };
+
+    /**
+     * Counters of the last sync.
+     */
+    struct Stats {
+        int httpCode = 0;          ///< Status of the last request, negative on connection errors.
+        uint32_t requests = 0;     ///< HTTP requests made, token requests included.
+        uint32_t pages = 0;        ///< Contacts pages downloaded.
+        uint64_t bodyBytes = 0;    ///< Response body bytes received.
+        double elapsedMs = 0;      ///< Wall time of the sync.
+        double parseMs = 0;        ///< Time spent parsing pages, slowdown included.
+        size_t peakHeapBytes = 0;  ///< Peak heap above the usage at the start of the sync.
+    };
+
+    HostSyncClient(uint16_t port, const Options& options);
+    HostSyncClient(const HostSyncClient&) = delete;
+    HostSyncClient& operator=(const HostSyncClient&) = delete;
+
+    /**
+     * Runs one sync.
+     *
+     * @param directory Receives the new directory on success; left untouched on failure.
+     * @return True if every page was downloaded and parsed.
+     */
+    bool sync(MemberDirectory& directory);
+
+    /**
+     * @return Counters of the last sync.
+     */
+    const Stats& getStats() const;
+
+    /**
+     * @return Every line ContactsSync logged during the last sync, newline separated.
+     */
+    static const std::string& getLog();
+
+private:
+    class ParserThread;
+    class TimedParser;
+
+    Options options;
+    PosixTransport transport;
+    ContactsSync contactsSync;
+    Stats stats;
+
+    static ContactsSync::Config syncConfig(const Options& options);
+};
+
+#endif // HOST_SYNC_CLIENT_H
@@ -0,0 +1,292 @@
+#include "MockWildApricot.h"
+#include "RecordedResponses.h"
+#include "HeapTracker.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+const char* const MockWildApricot::contactsPath = "/v2.1/accounts/123456/Contacts";
+
+namespace {
+
+const char* const FirstNames[] = {
+    "Ada", "Alan", "Barbara", "Bjarne", "Claude", "Dennis", "Donald", "Edsger", "Frances", "Grace",
+    "Guido", "Hedy", "Ivan", "James", "John", "Joan", "Ken", "Larry", "Linus", "Lynn",
+    "Margaret", "Mary", "Niklaus", "Radia", "Richard", "Rob", "Shafi", "Sophie", "Tim", "Whitfield",
+    "Yukihiro", "Zoë", "Anita", "Brian", "Carol", "Dana", "Elena", "Fernando", "Gloria", "Hal",
+    "Irene", "Jean", "Karen", "Leslie", "Marvin", "Nancy", "Ole", "Peter", "Quincy", "Rosalind",
+    "Seymour", "Tony", "Ursula", "Vint", "Wendy", "Xavier", "Yvonne", "Zack", "Amir", "Bea",
+    "Chen", "Dmitri", "Esther", "Farid"
+};
+
+const char* const LastNames[] = {
+    "Lovelace", "Turing", "Liskov", "Stroustrup", "Shannon", "Ritchie", "Knuth", "Dijkstra", "Allen", "Hopper",
+    "van Rossum", "Lamarr", "Sutherland", "Gosling", "McCarthy", "Clarke", "Thompson", "Wall", "Torvalds", "Conway",
+    "Hamilton", "Kenneth", "Wirth", "Perlman", "Stallman", "Pike", "Goldwasser", "Wilson", "Berners-Lee", "Diffie",
+    "Matsumoto", "Müller", "Borg", "Kernighan", "Shaw", "Scott", "Garcia", "Corbató", "Estrin", "Abelson",
+    "Greif", "Sammet", "Jones", "Lamport", "Minsky", "Lynch", "Dahl", "Naur", "Jones", "Picard",
+    "Cray", "Hoare", "Martin", "Cerf", "Hall", "Leroy", "Hsu", "Snyder", "Pnueli", "Laning",
+    "Wang", "Bertsekas", "Dyson", "Tabrizi"
+};
+
+const char* const LevelNames[] = {"Full Member", "Student Member", "Family Member", "Sponsor"};
+
+/**
+ * Value of a query parameter, accepting both "$name=" and the URL-encoded "%24name=".
+ */
+bool queryValue(const std::string& target, const char* name, std::string& value) {
+    for (const char* prefix : {"$", "%24"}) {
+        std::string key = std::string(prefix) + name + "=";
+        size_t start = target.find(key);
+        if (start != std::string::npos) {
+            start += key.size();
+            size_t end = target.find('&', start);
+            value = target.substr(start, end == std::string::npos ? std::string::npos : end - start);
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* statusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 401: return "Unauthorized";
+        case 404: return "Not Found";
+        case 429: return "Too Many Requests";
+        case 503: return "Service Unavailable";
+    }
+    return "Error";
+}
+
+}  // namespace
+
+MockWildApricot::MockWildApricot(const Config& config) : config(config) {}
+
+MockWildApricot::~MockWildApricot() {
+    stop();
+}
+
+bool MockWildApricot::start() {
+    listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+    if (listenSocket < 0) {
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t length = sizeof(address);
+    if (bind(listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || listen(listenSocket, 4) != 0
+        || getsockname(listenSocket, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        close(listenSocket);
+        listenSocket = -1;
+        return false;
+    }
+    port = ntohs(address.sin_port);
+    running = true;
+    serverThread = std::thread(&MockWildApricot::serve, this);
+    return true;
+}
+
+void MockWildApricot::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    // Unblocks accept() in the server thread; the socket is closed once the thread is done with it
+    shutdown(listenSocket, SHUT_RDWR);
+    serverThread.join();
+    close(listenSocket);
+    listenSocket = -1;
+}
+
+uint16_t MockWildApricot::getPort() const {
+    return port;
+}
+
+uint32_t MockWildApricot::getTokenRequests() const {
+    return tokenRequests;
+}
+
+uint32_t MockWildApricot::getContactsRequests() const {
+    return contactsRequests;
+}
+
+bool MockWildApricot::hasTag(uint32_t index) {
+    return index % 10 != 9;
+}
+
+uint32_t MockWildApricot::tagIdFor(uint32_t index) {
+    return 1000000 + index * 13;
+}
+
+uint32_t MockWildApricot::contactIdFor(uint32_t index) {
+    return 50000000 + index;
+}
+
+uint32_t MockWildApricot::taggedMembers(uint32_t contactCount) {
+    return contactCount - contactCount / 10;
+}
+
+std::string MockWildApricot::contactsPage(uint32_t skip, uint32_t top, uint32_t contactCount, bool selected) {
+    const size_t firstCount = sizeof(FirstNames) / sizeof(FirstNames[0]);
+    const size_t lastCount = sizeof(LastNames) / sizeof(LastNames[0]);
+    std::string body = "{\"Contacts\":[";
+    char record[4096];
+    char rfid[16];
+    for (uint32_t i = skip; i < contactCount && i < skip + top; i++) {
+        const char* first = FirstNames[i % firstCount];
+        const char* last = LastNames[(i / firstCount) % lastCount];
+        if (hasTag(i)) {
+            snprintf(rfid, sizeof(rfid), "%u", tagIdFor(i));
+        } else {
+            snprintf(rfid, sizeof(rfid), "\"\"");
+        }
+        snprintf(record, sizeof(record), selected ? RecordedSelectedContact : RecordedFullContact,
+                 first, last, i, first, last, LevelNames[i % 4], rfid, contactIdFor(i), contactIdFor(i));
+        if (i != skip) {
+            body += ',';
+        }
+        body += record;
+    }
+    body += "]}";
+    return body;
+}
+
+std::string MockWildApricot::currentToken() const {
+    return "mock-token-" + std::to_string(tokenGeneration);
+}
+
+void MockWildApricot::serve() {
+    // Server-side allocations are not part of the client's peak memory
+    HeapTracker::ignoreCurrentThread();
+    while (running) {
+        int client = accept(listenSocket, nullptr, nullptr);
+        if (client < 0) {
+            continue;
+        }
+        handleConnection(client);
+        close(client);
+    }
+}
+
+void MockWildApricot::handleConnection(int client) {
+    std::string request;
+    char chunk[2048];
+    size_t headerEnd;
+    while ((headerEnd = request.find("\r\n\r\n")) == std::string::npos) {
+        ssize_t received = recv(client, chunk, sizeof(chunk), 0);
+        if (received <= 0 || request.size() > 65536) {
+            return;
+        }
+        request.append(chunk, received);
+    }
+
+    // Drain a request body (the token form) so closing the socket does not reset the connection
+    size_t contentLength = 0;
+    size_t lengthHeader = request.find("Content-Length:");
+    if (lengthHeader != std::string::npos && lengthHeader < headerEnd) {
+        contentLength = strtoul(request.c_str() + lengthHeader + 15, nullptr, 10);
+    }
+    while (request.size() < headerEnd + 4 + contentLength) {
+        ssize_t received = recv(client, chunk, sizeof(chunk), 0);
+        if (received <= 0) {
+            break;
+        }
+        request.append(chunk, received);
+    }
+
+    size_t methodEnd = request.find(' ');
+    size_t targetEnd = request.find(' ', methodEnd + 1);
+    std::string method = request.substr(0, methodEnd);
+    std::string target = request.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+
+    if (config.latencyMs > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(config.latencyMs));
+    }
+
+    char body[1024];
+    if (method == "POST" && target == "/auth/token") {
+        tokenRequests++;
+        snprintf(body, sizeof(body), RecordedTokenResponse, currentToken().c_str());
+        respond(client, 200, body, false);
+        return;
+    }
+    if (method != "GET" || target.compare(0, strlen(contactsPath), contactsPath) != 0) {
+        respond(client, 404, "{}", false);
+        return;
+    }
+
+    uint32_t requestNumber = ++contactsRequests;
+    bool faulted = config.fault != Fault::None && requestNumber >= config.faultOnRequest
+                   && requestNumber < config.faultOnRequest + config.faultCount;
+    std::string authorization = "Authorization: Bearer " + currentToken() + "\r\n";
+    if (request.find(authorization) == std::string::npos) {
+        respond(client, 401, RecordedUnauthorizedResponse, false);
+        return;
+    }
+    if (faulted && config.fault == Fault::Unauthorized) {
+        tokenGeneration++; // The token expired: the client has to fetch a new one
+        respond(client, 401, RecordedUnauthorizedResponse, false);
+        return;
+    }
+    if (faulted && config.fault == Fault::TooManyRequests) {
+        respond(client, 429, RecordedRateLimitResponse, false);
+        return;
+    }
+    if (faulted && config.fault == Fault::ServerError) {
+        respond(client, 503, RecordedServerErrorResponse, false);
+        return;
+    }
+
+    bool truncate = faulted && config.fault == Fault::TruncatedBody;
+    std::string value;
+    if (queryValue(target, "count", value) && value == "true") {
+        snprintf(body, sizeof(body), RecordedCountResponse, config.contactCount);
+        respond(client, 200, body, truncate);
+        return;
+    }
+    uint32_t top = queryValue(target, "top", value) ? strtoul(value.c_str(), nullptr, 10) : config.contactCount;
+    uint32_t skip = queryValue(target, "skip", value) ? strtoul(value.c_str(), nullptr, 10) : 0;
+    bool selected = queryValue(target, "select", value);
+    std::string page = contactsPage(skip, top, config.contactCount, selected);
+    if (faulted && config.fault == Fault::MalformedBody) {
+        page.resize(page.size() / 2);
+    }
+    respond(client, 200, page, truncate);
+}
+
+void MockWildApricot::respond(int client, int status, const std::string& body, bool truncate) {
+    char header[256];
+    int headerLength = snprintf(header, sizeof(header),
+                                "HTTP/1.1 %d %s\r\nContent-Type: application/json; charset=utf-8\r\n"
+                                "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+                                status, statusText(status), body.size());
+    send(client, header, headerLength, MSG_NOSIGNAL);
+
+    size_t bodyLength = truncate ? body.size() / 2 : body.size();
+    // Send in TCP-segment sized chunks, pacing them when a bandwidth cap is set
+    const size_t chunkSize = 1460;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t sent = 0; sent < bodyLength;) {
+        size_t length = std::min(chunkSize, bodyLength - sent);
+        ssize_t written = send(client, body.data() + sent, length, MSG_NOSIGNAL);
+        if (written <= 0) {
+            return;
+        }
+        sent += written;
+        if (config.bytesPerSecond > 0) {
+            auto due = start + std::chrono::microseconds(sent * 1000000ULL / config.bytesPerSecond);
+            std::this_thread::sleep_until(due);
+        }
+    }
+}
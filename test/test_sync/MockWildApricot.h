@@ -0,0 +1,126 @@
+#ifndef MOCK_WILDAPRICOT_H
+#define MOCK_WILDAPRICOT_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Local stand-in for the WildApricot API, replaying recorded responses over HTTP on localhost.
+ *
+ * Serves POST /auth/token and GET <contactsPath> with `$count=true` or `$top`/`$skip` pages of a
+ * generated membership of any size. Latency, a bandwidth cap and faults (truncated bodies, 401, 429,
+ * 5xx) can be injected so sync throughput, peak memory and failure recovery are measured repeatably.
+ * Connections are handled one at a time and closed after each response, like the device's HttpClient.
+ */
+class MockWildApricot {
+public:
+    /**
+     * Fault injected into Contacts requests.
+     */
+    enum class Fault {
+        None,
+        TruncatedBody,   ///< Full Content-Length header, but the connection closes after half the body.
+        MalformedBody,   ///< Complete response whose body is only the first half of the JSON.
+        Unauthorized,    ///< 401; the current token is revoked, so the client must request a new one.
+        TooManyRequests, ///< 429.
+        ServerError      ///< 503.
+    };
+
+    /**
+     * Server behaviour.
+     */
+    struct Config {
+        uint32_t contactCount = 100;  ///< Size of the generated membership.
+        uint32_t latencyMs = 0;       ///< Delay before every response.
+        uint32_t bytesPerSecond = 0;  ///< Response bandwidth cap; 0 for unlimited.
+        Fault fault = Fault::None;    ///< Fault to inject.
+        uint32_t faultOnRequest = 0;  ///< First Contacts request (1-based, count request included) to fault.
+        uint32_t faultCount = 1;      ///< Number of consecutive Contacts requests to fault.
+    };
+
+    static const char* const contactsPath; ///< Contacts endpoint path served by the mock.
+
+    explicit MockWildApricot(const Config& config);
+    ~MockWildApricot();
+
+    /**
+     * Binds an ephemeral localhost port and starts serving on a background thread.
+     *
+     * @return True if the server is listening.
+     */
+    bool start();
+
+    /**
+     * Stops serving and joins the server thread.
+     */
+    void stop();
+
+    /**
+     * @return Port the server listens on.
+     */
+    uint16_t getPort() const;
+
+    /**
+     * @return Number of token requests served.
+     */
+    uint32_t getTokenRequests() const;
+
+    /**
+     * @return Number of Contacts requests served, count requests included.
+     */
+    uint32_t getContactsRequests() const;
+
+    /**
+     * @param index Contact index in [0, contactCount).
+     * @return True if the contact has an RFID tag (every tenth member has none).
+     */
+    static bool hasTag(uint32_t index);
+
+    /**
+     * @param index Contact index in [0, contactCount).
+     * @return RFID tag of the contact.
+     */
+    static uint32_t tagIdFor(uint32_t index);
+
+    /**
+     * @param index Contact index in [0, contactCount).
+     * @return WildApricot contact ID of the contact.
+     */
+    static uint32_t contactIdFor(uint32_t index);
+
+    /**
+     * @param contactCount Size of a generated membership.
+     * @return Number of those contacts with an RFID tag.
+     */
+    static uint32_t taggedMembers(uint32_t contactCount);
+
+    /**
+     * Generates one Contacts page body.
+     *
+     * @param skip Index of the first contact.
+     * @param top Maximum number of contacts.
+     * @param contactCount Size of the membership.
+     * @param selected True to replay the $select response shape instead of full records.
+     * @return JSON body.
+     */
+    static std::string contactsPage(uint32_t skip, uint32_t top, uint32_t contactCount, bool selected);
+
+private:
+    Config config;
+    int listenSocket = -1;
+    uint16_t port = 0;
+    std::thread serverThread;
+    std::atomic<bool> running{false};
+    std::atomic<uint32_t> tokenRequests{0};
+    std::atomic<uint32_t> contactsRequests{0};
+    uint32_t tokenGeneration = 1; ///< Bumped when a 401 revokes the current token.
+
+    void serve();
+    void handleConnection(int client);
+    void respond(int client, int status, const std::string& body, bool truncate);
+    std::string currentToken() const;
+};
+
+#endif // MOCK_WILDAPRICOT_H
@@ -0,0 +1,101 @@
+#include "PosixTransport.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+PosixTransport::PosixTransport(uint16_t port, uint32_t responseTimeoutMs)
+    : port(port), responseTimeoutMs(responseTimeoutMs) {}
+
+PosixTransport::~PosixTransport() {
+    stop();
+}
+
+int PosixTransport::request(const char* method, const char* path, const char* authorization,
+                            const char* contentType, const char* body) {
+    stop();
+    connection = socket(AF_INET, SOCK_STREAM, 0);
+    if (connection < 0) {
+        return -1;
+    }
+    timeval timeout = {static_cast<time_t>(responseTimeoutMs / 1000),
+                       static_cast<suseconds_t>(responseTimeoutMs % 1000 * 1000)};
+    setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if (connect(connection, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        stop();
+        return -1;
+    }
+
+    std::string message = std::string(method) + " " + path + " HTTP/1.1\r\nHost: localhost\r\n"
+                          + "Authorization: " + authorization + "\r\nContent-Type: " + contentType + "\r\n";
+    if (body != nullptr) {
+        message += "Content-Length: " + std::to_string(strlen(body)) + "\r\n";
+    }
+    message += "Connection: close\r\n\r\n";
+    if (body != nullptr) {
+        message += body;
+    }
+    if (send(connection, message.data(), message.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(message.size())) {
+        stop();
+        return -2;
+    }
+
+    // Status line and headers; whatever body follows them is kept for read()
+    std::string head;
+    char chunk[1024];
+    size_t headerEnd;
+    while ((headerEnd = head.find("\r\n\r\n")) == std::string::npos) {
+        ssize_t received = recv(connection, chunk, sizeof(chunk), 0);
+        if (received <= 0) {
+            stop();
+            return -3;
+        }
+        head.append(chunk, received);
+    }
+    size_t lengthHeader = head.find("Content-Length:");
+    if (lengthHeader != std::string::npos && lengthHeader < headerEnd) {
+        length = atoi(head.c_str() + lengthHeader + 15);
+    }
+    pending = head.substr(headerEnd + 4);
+    return atoi(head.c_str() + head.find(' ') + 1);
+}
+
+int PosixTransport::contentLength() {
+    return length;
+}
+
+int PosixTransport::read(char* buffer, size_t size) {
+    if (!pending.empty()) {
+        size_t count = std::min(size, pending.size());
+        memcpy(buffer, pending.data(), count);
+        pending.erase(0, count);
+        return static_cast<int>(count);
+    }
+    if (connection < 0) {
+        return 0;
+    }
+    ssize_t received = recv(connection, buffer, size, 0);
+    if (received < 0) {
+        // SO_RCVTIMEO expired; any other error means the connection is gone
+        return errno == EAGAIN || errno == EWOULDBLOCK ? -1 : 0;
+    }
+    return static_cast<int>(received);
+}
+
+void PosixTransport::stop() {
+    if (connection >= 0) {
+        close(connection);
+        connection = -1;
+    }
+    length = -1;
+    pending.clear();
+}
@@ -0,0 +1,39 @@
+#ifndef POSIX_TRANSPORT_H
+#define POSIX_TRANSPORT_H
+
+#include <cstdint>
+#include <string>
+#include "SyncTransport.h"
+
+/**
+ * @brief SyncTransport over POSIX sockets to MockWildApricot on localhost.
+ *
+ * Every request opens a new connection and sends `Connection: close`, so each response ends when the
+ * server closes the socket, and a short body shows up as a truncated read like it does on the device.
+ */
+class PosixTransport : public SyncTransport {
+public:
+    /**
+     * @param port Port MockWildApricot listens on.
+     * @param responseTimeoutMs Maximum time to wait for a response or for more body data.
+     */
+    PosixTransport(uint16_t port, uint32_t responseTimeoutMs);
+    ~PosixTransport() override;
+    PosixTransport(const PosixTransport&) = delete;
+    PosixTransport& operator=(const PosixTransport&) = delete;
+
+    int request(const char* method, const char* path, const char* authorization,
+                const char* contentType, const char* body) override;
+    int contentLength() override;
+    int read(char* buffer, size_t size) override;
+    void stop() override;
+
+private:
+    uint16_t port;
+    uint32_t responseTimeoutMs;
+    int connection = -1;
+    int length = -1;       ///< Content-Length of the current response, -1 if absent.
+    std::string pending;   ///< Body bytes that arrived together with the headers.
+};
+
+#endif // POSIX_TRANSPORT_H
@@ -0,0 +1,67 @@
+#ifndef RECORDED_RESPONSES_H
+#define RECORDED_RESPONSES_H
+
+/**
+ * WildApricot responses recorded from the v2.1 API and anonymized, used by MockWildApricot as
+ * printf templates. The RFID custom field is exposed as "RFIDFieldName", matching what Auth reads.
+ */
+
+/**
+ * POST /auth/token. Argument: access token.
+ */
+static const char* const RecordedTokenResponse =
+    "{\"access_token\":\"%s\",\"token_type\":\"Bearer\",\"expires_in\":1800,"
+    "\"refresh_token\":\"rt_2a7d1c0e9f4b4c1a8e2d\",\"Permissions\":[{\"AccountId\":123456,"
+    "\"SecurityProfileId\":42,\"AvailableScopes\":[\"contacts_view\",\"finances_view\","
+    "\"events_view\",\"account_view\",\"membership_levels_view\"]}]}";
+
+/**
+ * GET Contacts?$count=true. Argument: contact count.
+ */
+static const char* const RecordedCountResponse = "{\"Count\":%u}";
+
+/**
+ * One contact of GET Contacts without $select, i.e. with every field value.
+ * Arguments: first name, last name, index (email), first name, last name, level name,
+ * RFID value (JSON literal), contact ID, contact ID.
+ */
+static const char* const RecordedFullContact =
+    "{\"FirstName\":\"%s\",\"LastName\":\"%s\",\"Email\":\"member%u@example.org\","
+    "\"DisplayName\":\"%s %s\",\"Organization\":\"\",\"ProfileLastUpdated\":\"2024-01-15T10:22:31-05:00\","
+    "\"MembershipLevel\":{\"Id\":1234567,\"Url\":\"https://api.wildapricot.org/v2.1/accounts/123456/MembershipLevels/1234567\","
+    "\"Name\":\"%s\"},\"MembershipEnabled\":true,\"Status\":\"Active\",\"IsAccountAdministrator\":false,"
+    "\"TermsOfUseAccepted\":true,\"FieldValues\":["
+    "{\"FieldName\":\"Archived\",\"Value\":false,\"SystemCode\":\"IsArchived\"},"
+    "{\"FieldName\":\"Donor\",\"Value\":false,\"SystemCode\":\"IsDonor\"},"
+    "{\"FieldName\":\"Event registrant\",\"Value\":true,\"SystemCode\":\"IsEventAttendee\"},"
+    "{\"FieldName\":\"Member\",\"Value\":true,\"SystemCode\":\"IsMember\"},"
+    "{\"FieldName\":\"Suspended member\",\"Value\":false,\"SystemCode\":\"IsSuspendedMember\"},"
+    "{\"FieldName\":\"Event announcements\",\"Value\":true,\"SystemCode\":\"ReceiveEventReminders\"},"
+    "{\"FieldName\":\"Member since\",\"Value\":\"2021-06-03T00:00:00-04:00\",\"SystemCode\":\"MemberSince\"},"
+    "{\"FieldName\":\"Renewal due\",\"Value\":\"2025-06-03T00:00:00-04:00\",\"SystemCode\":\"RenewalDue\"},"
+    "{\"FieldName\":\"Membership status\",\"Value\":{\"Id\":1,\"Label\":\"Active\",\"Value\":\"Active\"},\"SystemCode\":\"Status\"},"
+    "{\"FieldName\":\"Phone\",\"Value\":\"412-555-0100\",\"SystemCode\":\"custom-11866120\"},"
+    "{\"FieldName\":\"Emergency contact\",\"Value\":\"\",\"SystemCode\":\"custom-11866121\"}],"
+    "\"RFIDFieldName\":%s,\"Id\":%u,\"Url\":\"https://api.wildapricot.org/v2.1/accounts/123456/Contacts/%u\"}";
+
+/**
+ * One contact of GET Contacts with $select='Id','DisplayName','RFIDFieldName': system fields only.
+ * Arguments: first name, last name, index (email), first name, last name, level name,
+ * RFID value (JSON literal), contact ID, contact ID.
+ */
+static const char* const RecordedSelectedContact =
+    "{\"FirstName\":\"%s\",\"LastName\":\"%s\",\"Email\":\"member%u@example.org\","
+    "\"DisplayName\":\"%s %s\",\"Organization\":\"\",\"ProfileLastUpdated\":\"2024-01-15T10:22:31-05:00\","
+    "\"MembershipLevel\":{\"Id\":1234567,\"Url\":\"https://api.wildapricot.org/v2.1/accounts/123456/MembershipLevels/1234567\","
+    "\"Name\":\"%s\"},\"MembershipEnabled\":true,\"Status\":\"Active\",\"IsAccountAdministrator\":false,"
+    "\"TermsOfUseAccepted\":true,\"FieldValues\":[],"
+    "\"RFIDFieldName\":%s,\"Id\":%u,\"Url\":\"https://api.wildapricot.org/v2.1/accounts/123456/Contacts/%u\"}";
+
+/**
+ * Error bodies returned with injected 401, 429 and 5xx statuses.
+ */
+static const char* const RecordedUnauthorizedResponse = "{\"code\":\"Unauthorized\",\"message\":\"Invalid or expired access token\"}";
+static const char* const RecordedRateLimitResponse = "{\"code\":\"TooManyRequests\",\"message\":\"API rate limit exceeded\"}";
+static const char* const RecordedServerErrorResponse = "{\"code\":\"ServiceUnavailable\",\"message\":\"Service temporarily unavailable\"}";
+
+#endif // RECORDED_RESPONSES_H
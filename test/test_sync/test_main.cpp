@@ -0,0 +1,362 @@
+#include <unity.h>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include "HeapTracker.h"
+#include "HostSyncClient.h"
+#include "MockWildApricot.h"
+
+/**
+ * Sync tests against the WildApricot replay server: correctness for memberships of 100 to 50k
+ * contacts, latency and bandwidth shaping, and recovery from truncated bodies, 401, 429 and 5xx.
+ * Throughput and peak heap per sync are printed for comparison between changes, and serial and
+ * pipelined syncs are benchmarked against the same shaped server.
+ */
+
+namespace {
+
+MockWildApricot* server = nullptr;
+
+void startServer(const MockWildApricot::Config& config) {
+    server = new MockWildApricot(config);
+    TEST_ASSERT_TRUE_MESSAGE(server->start(), "Replay server failed to start");
+}
+
+void checkDirectory(const MemberDirectory& directory, uint32_t contactCount) {
+    TEST_ASSERT_EQUAL_UINT32(MockWildApricot::taggedMembers(contactCount), directory.size());
+    for (uint32_t i = 0; i < contactCount; i += 97) {
+        size_t index = directory.find(MockWildApricot::tagIdFor(i));
+        if (!MockWildApricot::hasTag(i)) {
+            TEST_ASSERT_TRUE(index == MemberDirectory::npos);
+            continue;
+        }
+        TEST_ASSERT_TRUE(index != MemberDirectory::npos);
+        TEST_ASSERT_EQUAL_UINT32(MockWildApricot::contactIdFor(i), directory.getContactId(index));
+    }
+}
+
+uint32_t pagesFor(uint32_t contactCount) {
+    const uint32_t pageSize = HostSyncClient::Options().pageSize;
+    return (contactCount + pageSize - 1) / pageSize;
+}
+
+void report(const char* label, uint32_t contactCount, const HostSyncClient::Stats& stats) {
+    char line[240];
+    snprintf(line, sizeof(line), "%s: %u contacts, %u pages, %.1f ms (parse %.1f ms), %.1f contacts/s, %.2f MB, "
+             "peak heap %zu bytes%s", label, contactCount, stats.pages, stats.elapsedMs, stats.parseMs,
+             contactCount * 1000.0 / stats.elapsedMs, stats.bodyBytes / 1e6, stats.peakHeapBytes,
+             HeapTracker::isAvailable() ? "" : " (untracked)");
+    TEST_MESSAGE(line);
+}
+
+/**
+ * Median wall time of repeated syncs, to keep scheduler noise out of the comparison.
+ */
+double medianSyncMs(const HostSyncClient::Options& options, uint32_t contactCount, HostSyncClient::Stats& last) {
+    const int runs = 3;
+    double elapsed[runs];
+    for (int i = 0; i < runs; i++) {
+        HostSyncClient client(server->getPort(), options);
+        MemberDirectory directory;
+        TEST_ASSERT_TRUE(client.sync(directory));
+        checkDirectory(directory, contactCount);
+        elapsed[i] = client.getStats().elapsedMs;
+        last = client.getStats();
+    }
+    std::sort(elapsed, elapsed + runs);
+    return elapsed[runs / 2];
+}
+
+}  // namespace
+
+void setUp(void) {}
+
+void tearDown(void) {
+    delete server;
+    server = nullptr;
+}
+
+void test_sync_downloads_every_tagged_member(void) {
+    MockWildApricot::Config config;
+    config.contactCount = 250;
+    startServer(config);
+    HostSyncClient::Options options;
+    options.maxNameLength = 24;
+    HostSyncClient client(server->getPort(), options);
+    MemberDirectory directory;
+
+    TEST_ASSERT_TRUE(client.sync(directory));
+    checkDirectory(directory, config.contactCount);
+    size_t index = directory.find(MockWildApricot::tagIdFor(0));
+    TEST_ASSERT_EQUAL_STRING("Ada Lovelace", directory.getDisplayName(index));
+    TEST_ASSERT_EQUAL_UINT32(1, server->getTokenRequests());
+    TEST_ASSERT_EQUAL_UINT32(1 + pagesFor(config.contactCount), server->getContactsRequests());
+}
+
+void test_sync_membership_sizes(void) {
+    const uint32_t sizes[] = {100, 1000, 10000, 50000};
+    for (uint32_t contactCount : sizes) {
+        MockWildApricot::Config config;
+        config.contactCount = contactCount;
+        startServer(config);
+        for (bool pipelined : {false, true}) {
+            HostSyncClient::Options options;
+            options.pipelined = pipelined;
+            HostSyncClient client(server->getPort(), options);
+            MemberDirectory directory;
+
+            TEST_ASSERT_TRUE(client.sync(directory));
+            checkDirectory(directory, contactCount);
+            TEST_ASSERT_EQUAL_UINT32(pagesFor(contactCount), client.getStats().pages);
+            report(pipelined ? "pipelined" : "serial", contactCount, client.getStats());
+        }
+        delete server;
+        server = nullptr;
+    }
+}
+
+void test_selected_page_fits_page_buffer(void) {
+    // Every generated record, longest names included, stays within the per-contact budget
+    size_t longest = 0;
+    for (uint32_t i = 0; i < 50000; i++) {
+        longest = std::max(longest, MockWildApricot::contactsPage(i, 1, 50000, true).size());
+    }
+    TEST_ASSERT_LESS_OR_EQUAL(ContactsParser::maxContactBytes, longest);
+
+    const uint32_t pageSize = HostSyncClient::Options().pageSize;
+    std::string page = MockWildApricot::contactsPage(0, pageSize, pageSize, true);
+    TEST_ASSERT_LESS_THAN(CONTACTS_PAGE_BUFFER_SIZE, page.size());
+    char line[160];
+    snprintf(line, sizeof(line), "%u contacts per %u byte page; longest record %zu bytes, full page %zu bytes",
+             pageSize, CONTACTS_PAGE_BUFFER_SIZE, longest, page.size());
+    TEST_MESSAGE(line);
+}
+
+void test_unselected_page_overflows_page_buffer(void) {
+    // Without $select every custom field value is returned and the same page no longer fits
+    MockWildApricot::Config config;
+    startServer(config);
+    HostSyncClient::Options options;
+    options.selectFields = false;
+    HostSyncClient client(server->getPort(), options);
+    MemberDirectory directory;
+
+    TEST_ASSERT_FALSE(client.sync(directory));
+    TEST_ASSERT_EQUAL_UINT32(0, directory.size());
+}
+
+void test_serial_vs_pipelined_benchmark(void) {
+    // 20 ms round trips at 500 KB/s stand in for the device's connection to WildApricot. Parsing is
+    // slowed down to emulate the ESP32; the host parses a page in a fraction of a millisecond.
+    MockWildApricot::Config config;
+    config.contactCount = 600;
+    config.latencyMs = 20;
+    config.bytesPerSecond = 500000;
+    startServer(config);
+
+    for (uint32_t slowdown : {1u, 100u, 300u}) {
+        HostSyncClient::Options serial;
+        serial.parseSlowdown = slowdown;
+        HostSyncClient::Options pipelined = serial;
+        pipelined.pipelined = true;
+
+        HostSyncClient::Stats serialStats;
+        HostSyncClient::Stats pipelinedStats;
+        double serialMs = medianSyncMs(serial, config.contactCount, serialStats);
+        double pipelinedMs = medianSyncMs(pipelined, config.contactCount, pipelinedStats);
+        char line[200];
+        snprintf(line, sizeof(line), "parse x%u: serial %.0f ms (parse %.0f ms), pipelined %.0f ms, speedup %.2fx",
+                 slowdown, serialMs, serialStats.parseMs, pipelinedMs, serialMs / pipelinedMs);
+        // Only reported: wall-clock comparisons flake on a loaded host. Both modes still have to sync
+        // every member correctly, which medianSyncMs checks.
+        TEST_MESSAGE(line);
+    }
+}
+
+void test_sync_with_latency(void) {
+    MockWildApricot::Config config;
+    config.contactCount = 150;
+    config.latencyMs = 40;
+    startServer(config);
+    HostSyncClient client(server->getPort(), HostSyncClient::Options());
+    MemberDirectory directory;
+
+    TEST_ASSERT_TRUE(client.sync(directory));
+    // Token, count and every page, each delayed
+    uint32_t requests = 2 + pagesFor(config.contactCount);
+    TEST_ASSERT_EQUAL_UINT32(requests, client.getStats().requests);
+    TEST_ASSERT_GREATER_OR_EQUAL(requests * 40, static_cast<long>(client.getStats().elapsedMs));
+    report("latency 40ms", config.contactCount, client.getStats());
+}
+
+void test_sync_with_bandwidth_cap(void) {
+    MockWildApricot::Config config;
+    config.contactCount = 200;
+    config.bytesPerSecond = 1000000;
+    startServer(config);
+    HostSyncClient client(server->getPort(), HostSyncClient::Options());
+    MemberDirectory directory;
+
+    TEST_ASSERT_TRUE(client.sync(directory));
+    const HostSyncClient::Stats& stats = client.getStats();
+    long minimumMs = static_cast<long>(stats.bodyBytes * 1000 / config.bytesPerSecond);
+    TEST_ASSERT_GREATER_OR_EQUAL(minimumMs * 9 / 10, static_cast<long>(stats.elapsedMs));
+    report("1 MB/s", config.contactCount, stats);
+}
+
+void test_truncated_page_fails_sync_and_next_sync_recovers(void) {
+    for (bool pipelined : {false, true}) {
+        MockWildApricot::Config config;
+        config.contactCount = 300;
+        config.fault = MockWildApricot::Fault::TruncatedBody;
+        config.faultOnRequest = 3;
+        startServer(config);
+        HostSyncClient::Options options;
+        options.pipelined = pipelined;
+        HostSyncClient client(server->getPort(), options);
+        MemberDirectory directory;
+
+        TEST_ASSERT_FALSE(client.sync(directory));
+        TEST_ASSERT_EQUAL_UINT32(0, directory.size());
+        TEST_ASSERT_TRUE(client.sync(directory));
+        checkDirectory(directory, config.contactCount);
+        delete server;
+        server = nullptr;
+    }
+}
+
+void test_malformed_page_stops_download(void) {
+    // Once a page fails to parse the sync cannot succeed, so the remaining pages are not requested
+    for (bool pipelined : {false, true}) {
+        MockWildApricot::Config config;
+        config.contactCount = 100 * HostSyncClient::Options().pageSize;
+        config.fault = MockWildApricot::Fault::MalformedBody;
+        config.faultOnRequest = 3;
+        startServer(config);
+        HostSyncClient::Options options;
+        options.pipelined = pipelined;
+        HostSyncClient client(server->getPort(), options);
+        MemberDirectory directory;
+
+        TEST_ASSERT_FALSE(client.sync(directory));
+        TEST_ASSERT_EQUAL_UINT32(0, directory.size());
+        // The count, the pages up to the bad one, and at most a pool's worth downloaded meanwhile
+        TEST_ASSERT_LESS_OR_EQUAL(3 + options.poolSize + 1, server->getContactsRequests());
+        delete server;
+        server = nullptr;
+    }
+}
+
+void test_truncated_count_fails_sync(void) {
+    MockWildApricot::Config config;
+    config.fault = MockWildApricot::Fault::TruncatedBody;
+    config.faultOnRequest = 1;
+    startServer(config);
+    HostSyncClient client(server->getPort(), HostSyncClient::Options());
+    MemberDirectory directory;
+
+    TEST_ASSERT_FALSE(client.sync(directory));
+    TEST_ASSERT_EQUAL_UINT32(1, server->getContactsRequests());
+}
+
+void test_unauthorized_requests_new_token_and_retries(void) {
+    for (bool pipelined : {false, true}) {
+        MockWildApricot::Config config;
+        config.contactCount = 300;
+        config.fault = MockWildApricot::Fault::Unauthorized;
+        config.faultOnRequest = 3;
+        startServer(config);
+        HostSyncClient::Options options;
+        options.pipelined = pipelined;
+        HostSyncClient client(server->getPort(), options);
+        MemberDirectory directory;
+
+        TEST_ASSERT_TRUE(client.sync(directory));
+        checkDirectory(directory, config.contactCount);
+        TEST_ASSERT_EQUAL_UINT32(2, server->getTokenRequests());
+        TEST_ASSERT_TRUE(HostSyncClient::getLog().find("Auth token rejected") != std::string::npos);
+        delete server;
+        server = nullptr;
+    }
+}
+
+void test_repeated_unauthorized_fails_sync(void) {
+    MockWildApricot::Config config;
+    config.fault = MockWildApricot::Fault::Unauthorized;
+    config.faultOnRequest = 1;
+    config.faultCount = 2;
+    startServer(config);
+    HostSyncClient client(server->getPort(), HostSyncClient::Options());
+    MemberDirectory directory;
+
+    TEST_ASSERT_FALSE(client.sync(directory));
+    TEST_ASSERT_EQUAL_INT(401, client.getStats().httpCode);
+    TEST_ASSERT_EQUAL_UINT32(2, server->getTokenRequests());
+}
+
+void test_directory_larger_than_free_block_fails_sync(void) {
+    // With names the arena outgrows the staging block; it is only allocated if it fits the largest
+    // free block, otherwise the old directory is kept
+    MockWildApricot::Config config;
+    config.contactCount = 300;
+    startServer(config);
+    HostSyncClient::Options options;
+    options.maxNameLength = 24;
+    options.largestFreeBlock = 1024;
+    HostSyncClient client(server->getPort(), options);
+    MemberDirectory directory;
+
+    TEST_ASSERT_FALSE(client.sync(directory));
+    TEST_ASSERT_EQUAL_UINT32(0, directory.size());
+    TEST_ASSERT_TRUE(HostSyncClient::getLog().find("Not enough memory") != std::string::npos);
+}
+
+void test_rate_limit_fails_sync_and_next_sync_recovers(void) {
+    MockWildApricot::Config config;
+    config.contactCount = 300;
+    config.fault = MockWildApricot::Fault::TooManyRequests;
+    config.faultOnRequest = 2;
+    startServer(config);
+    HostSyncClient client(server->getPort(), HostSyncClient::Options());
+    MemberDirectory directory;
+
+    TEST_ASSERT_FALSE(client.sync(directory));
+    TEST_ASSERT_EQUAL_INT(429, client.getStats().httpCode);
+    TEST_ASSERT_TRUE(client.sync(directory));
+    checkDirectory(directory, config.contactCount);
+}
+
+void test_server_error_fails_sync_and_next_sync_recovers(void) {
+    MockWildApricot::Config config;
+    config.contactCount = 300;
+    config.fault = MockWildApricot::Fault::ServerError;
+    config.faultOnRequest = 4;
+    startServer(config);
+    HostSyncClient client(server->getPort(), HostSyncClient::Options());
+    MemberDirectory directory;
+
+    TEST_ASSERT_FALSE(client.sync(directory));
+    TEST_ASSERT_EQUAL_INT(503, client.getStats().httpCode);
+    TEST_ASSERT_TRUE(client.sync(directory));
+    checkDirectory(directory, config.contactCount);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_sync_downloads_every_tagged_member);
+    RUN_TEST(test_sync_membership_sizes);
+    RUN_TEST(test_selected_page_fits_page_buffer);
+    RUN_TEST(test_unselected_page_overflows_page_buffer);
+    RUN_TEST(test_serial_vs_pipelined_benchmark);
+    RUN_TEST(test_sync_with_latency);
+    RUN_TEST(test_sync_with_bandwidth_cap);
+    RUN_TEST(test_truncated_page_fails_sync_and_next_sync_recovers);
+    RUN_TEST(test_malformed_page_stops_download);
+    RUN_TEST(test_truncated_count_fails_sync);
+    RUN_TEST(test_unauthorized_requests_new_token_and_retries);
+    RUN_TEST(test_repeated_unauthorized_fails_sync);
+    RUN_TEST(test_directory_larger_than_free_block_fails_sync);
+    RUN_TEST(test_rate_limit_fails_sync_and_next_sync_recovers);
+    RUN_TEST(test_server_error_fails_sync_and_next_sync_recovers);
+    return UNITY_END();
+}
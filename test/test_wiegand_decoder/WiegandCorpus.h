@@ -0,0 +1,62 @@
+#ifndef WIEGAND_CORPUS_H
+#define WIEGAND_CORPUS_H
+
+#include <cstdint>
+
+/**
+ * Seed corpus of raw frames as RFIDReader hands them to the decoder: valid cards of each format next
+ * to the noise seen on real readers (line glitches, keypad bursts, lost or extra bits, flipped bits,
+ * cards of other formats, and overlong frames whose count stops at maxFrameBits + 1).
+ */
+struct CorpusFrame {
+    const char* description;
+    uint64_t frame;         ///< Received bits, first bit most significant.
+    uint8_t bitCount;       ///< Bits received.
+    uint8_t validFormat;    ///< Bit length of the one format that accepts the frame, 0 if none does.
+    uint32_t facilityCode;  ///< Expected facility code when valid.
+    uint32_t cardNumber;    ///< Expected card number when valid.
+    uint32_t tagId;         ///< Expected tag ID when valid.
+};
+
+static const CorpusFrame WiegandCorpus[] = {
+    // Valid cards
+    {"H10301 facility 13 card 31337", 0x1AF4D3ULL, 26, 26, 13, 31337, 883305},
+    {"H10301 facility 0 card 1", 0x2ULL, 26, 26, 0, 1, 1},
+    {"H10301 facility 255 card 65535", 0x1FFFFFFULL, 26, 26, 255, 65535, 16777215},
+    {"34-bit facility 4660 card 22136", 0x22468ACF1ULL, 34, 34, 4660, 22136, 305419896},
+    {"34-bit facility 0 card 0", 0x1ULL, 34, 34, 0, 0, 0},
+    {"H10304 facility 1234 card 300000", 0x4D2927C0ULL, 37, 37, 1234, 300000, 647271392},
+    {"H10304 facility 65535 card 524287, tag truncated to 32 bits", 0xFFFFFFFFFULL, 37, 37, 65535, 524287, 4294967295u},
+
+    // Line noise and keypads
+    {"Single glitch pulse", 0x1ULL, 1, 0, 0, 0, 0},
+    {"Two glitch pulses", 0x2ULL, 2, 0, 0, 0, 0},
+    {"4-bit keypad digit", 0x5ULL, 4, 0, 0, 0, 0},
+    {"8-bit keypad digit with complement", 0xA5ULL, 8, 0, 0, 0, 0},
+    {"EMI burst filling the frame buffer", 0xFFFFFFFFFFFFFFFFULL, 64, 0, 0, 0, 0},
+    {"Overlong frame, count capped at maxFrameBits + 1", 0x5555555555555555ULL, 65, 0, 0, 0, 0},
+
+    // Damaged 26-bit frames
+    {"H10301 with its last bit lost", 0x1AF4D3ULL >> 1, 25, 0, 0, 0, 0},
+    {"H10301 with a trailing extra bit", (0x1AF4D3ULL << 1) | 1, 27, 0, 0, 0, 0},
+    {"H10301 with a flipped card bit", 0x1AF4D3ULL ^ 0x100, 26, 0, 0, 0, 0},
+    {"H10301 with a flipped facility bit", 0x1AF4D3ULL ^ 0x200000, 26, 0, 0, 0, 0},
+    {"H10301 with both parity bits flipped", 0x1AF4D3ULL ^ 0x2000001ULL, 26, 0, 0, 0, 0},
+    {"26 zero bits (stuck DATA1)", 0x0ULL, 26, 0, 0, 0, 0},
+    {"26 one bits (stuck DATA0)", 0x3FFFFFFULL, 26, 0, 0, 0, 0},
+
+    // Damaged 34 and 37-bit frames
+    {"34-bit with its last bit lost", 0x22468ACF1ULL >> 1, 33, 0, 0, 0, 0},
+    {"34-bit with a flipped card bit", 0x22468ACF1ULL ^ 0x10, 34, 0, 0, 0, 0},
+    {"34 one bits", 0x3FFFFFFFFULL, 34, 0, 0, 0, 0},
+    {"H10304 with the shared parity bit flipped", 0x4D2927C0ULL ^ (1ULL << 18), 37, 0, 0, 0, 0},
+    {"H10304 with a trailing extra bit", 0x4D2927C0ULL << 1, 38, 0, 0, 0, 0},
+    {"H10304 with its first bit lost", 0x4D2927C0ULL & 0xFFFFFFFFFULL, 36, 0, 0, 0, 0},
+
+    // Other formats
+    {"35-bit HID Corporate 1000", 0x2A5A5A5A5ULL, 35, 0, 0, 0, 0},
+    {"32-bit raw card serial", 0xDEADBEEFULL, 32, 0, 0, 0, 0},
+    {"48-bit HID Corporate 1000", 0x8123456789ABULL, 48, 0, 0, 0, 0},
+};
+
+#endif // WIEGAND_CORPUS_H
@@ -0,0 +1,235 @@
+#include <unity.h>
+#include <chrono>
+#include <cstdio>
+#include "WiegandDecoder.h"
+#include "WiegandCorpus.h"
+
+/**
+ * WiegandDecoder against the seed corpus and seeded fuzzing for all three formats, checked against a
+ * bit-by-bit reference implementation, plus a decode throughput benchmark.
+ */
+
+namespace {
+
+uint64_t randomState = 0x9E3779B97F4A7C15ULL;
+
+uint64_t nextRandom() {
+    // xorshift64
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 7;
+    randomState ^= randomState << 17;
+    return randomState;
+}
+
+/**
+ * Number of one bits at positions [low, high] of a frame, counted one bit at a time.
+ */
+unsigned onesBetween(uint64_t frame, unsigned high, unsigned low) {
+    unsigned ones = 0;
+    for (unsigned position = low; position <= high; position++) {
+        ones += (frame >> position) & 1;
+    }
+    return ones;
+}
+
+/**
+ * Reference check: the leading bit makes the upper half (rounded up) even, the trailing bit makes the
+ * lower half (rounded up) odd. For 37 bits the halves share the middle bit.
+ */
+bool referenceValid(uint64_t frame, unsigned bits) {
+    unsigned half = (bits + 1) / 2;
+    return onesBetween(frame, bits - 1, bits - half) % 2 == 0 && onesBetween(frame, half - 1, 0) % 2 == 1;
+}
+
+template <typename Format>
+uint64_t encode(uint64_t payload) {
+    unsigned half = (Format::bits + 1) / 2;
+    uint64_t frame = (payload & ((1ULL << (Format::bits - 2)) - 1)) << 1;
+    if (onesBetween(frame, Format::bits - 1, Format::bits - half) % 2 != 0) {
+        frame |= 1ULL << (Format::bits - 1);
+    }
+    if (onesBetween(frame, half - 1, 0) % 2 == 0) {
+        frame |= 1;
+    }
+    return frame;
+}
+
+template <typename Format>
+void checkCorpus() {
+    WiegandDecoder<Format> decoder;
+    for (const CorpusFrame& entry : WiegandCorpus) {
+        WiegandCredential credential;
+        auto result = decoder.decode(entry.frame, entry.bitCount, credential);
+        if (entry.validFormat == Format::bits) {
+            TEST_ASSERT_TRUE_MESSAGE(result == WiegandDecoder<Format>::Result::Ok, entry.description);
+            TEST_ASSERT_EQUAL_UINT32(entry.facilityCode, credential.facilityCode);
+            TEST_ASSERT_EQUAL_UINT32(entry.cardNumber, credential.cardNumber);
+            TEST_ASSERT_EQUAL_UINT32(entry.tagId, credential.tagId);
+        } else {
+            TEST_ASSERT_FALSE_MESSAGE(result == WiegandDecoder<Format>::Result::Ok, entry.description);
+        }
+    }
+}
+
+template <typename Format>
+void checkRoundTrip() {
+    WiegandDecoder<Format> decoder;
+    for (int i = 0; i < 100000; i++) {
+        uint64_t payload = nextRandom() & ((1ULL << (Format::bits - 2)) - 1);
+        WiegandCredential credential;
+        TEST_ASSERT_TRUE(decoder.decode(encode<Format>(payload), Format::bits, credential)
+                         == WiegandDecoder<Format>::Result::Ok);
+        TEST_ASSERT_EQUAL_UINT32(static_cast<uint32_t>(payload >> Format::cardBits), credential.facilityCode);
+        TEST_ASSERT_EQUAL_UINT32(static_cast<uint32_t>(payload & ((1ULL << Format::cardBits) - 1)), credential.cardNumber);
+        TEST_ASSERT_EQUAL_UINT32(static_cast<uint32_t>(payload), credential.tagId);
+    }
+}
+
+template <typename Format>
+void checkSingleBitFlips() {
+    WiegandDecoder<Format> decoder;
+    for (int i = 0; i < 10000; i++) {
+        uint64_t frame = encode<Format>(nextRandom());
+        for (unsigned position = 0; position < Format::bits; position++) {
+            WiegandCredential credential;
+            TEST_ASSERT_TRUE(decoder.decode(frame ^ (1ULL << position), Format::bits, credential)
+                             == WiegandDecoder<Format>::Result::BadParity);
+        }
+    }
+}
+
+template <typename Format>
+void checkRandomFramesAgainstReference() {
+    WiegandDecoder<Format> decoder;
+    const uint64_t frameMask = (1ULL << Format::bits) - 1;
+    uint32_t accepted = 0;
+    for (int i = 0; i < 1000000; i++) {
+        uint64_t frame = nextRandom() & frameMask;
+        WiegandCredential credential;
+        bool ok = decoder.decode(frame, Format::bits, credential) == WiegandDecoder<Format>::Result::Ok;
+        TEST_ASSERT_EQUAL(referenceValid(frame, Format::bits), ok);
+        accepted += ok;
+    }
+    // Two independent parity bits: about a quarter of random frames pass
+    TEST_ASSERT_UINT32_WITHIN(5000, 250000, accepted);
+}
+
+template <typename Format>
+void checkShortAndOverlongFrames() {
+    WiegandDecoder<Format> decoder;
+    for (unsigned bitCount = 0; bitCount <= 65; bitCount++) {
+        if (bitCount == Format::bits) {
+            continue;
+        }
+        for (int i = 0; i < 1000; i++) {
+            // Valid frames with bits lost or added, and random frames of that length
+            uint64_t valid = encode<Format>(nextRandom());
+            uint64_t frame = bitCount < Format::bits ? valid >> (Format::bits - bitCount)
+                                                     : (valid << (bitCount - Format::bits)) | (nextRandom() & 1);
+            WiegandCredential credential;
+            TEST_ASSERT_TRUE(decoder.decode(frame, bitCount, credential) == WiegandDecoder<Format>::Result::BadLength);
+            TEST_ASSERT_TRUE(decoder.decode(nextRandom(), bitCount, credential) == WiegandDecoder<Format>::Result::BadLength);
+        }
+    }
+}
+
+template <typename Format>
+void checkFacilityFilter(uint32_t facility) {
+    WiegandDecoder<Format> decoder(facility);
+    WiegandCredential credential;
+    uint64_t match = encode<Format>((static_cast<uint64_t>(facility) << Format::cardBits) | 42);
+    uint64_t other = encode<Format>((static_cast<uint64_t>(facility + 1) << Format::cardBits) | 42);
+    TEST_ASSERT_TRUE(decoder.decode(match, Format::bits, credential) == WiegandDecoder<Format>::Result::Ok);
+    TEST_ASSERT_EQUAL_UINT32(facility, credential.facilityCode);
+    TEST_ASSERT_TRUE(decoder.decode(other, Format::bits, credential) == WiegandDecoder<Format>::Result::WrongFacility);
+}
+
+template <typename Format>
+void benchmark(const char* name) {
+    // Half valid frames, half random noise of the right length, pre-generated so only decoding is timed
+    const int frameCount = 4096;
+    uint64_t frames[frameCount];
+    for (int i = 0; i < frameCount; i++) {
+        frames[i] = i % 2 == 0 ? encode<Format>(nextRandom()) : nextRandom() & ((1ULL << Format::bits) - 1);
+    }
+
+    WiegandDecoder<Format> decoder;
+    WiegandCredential credential;
+    volatile uint32_t sink = 0;
+    const int rounds = 1000;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++) {
+        for (int i = 0; i < frameCount; i++) {
+            if (decoder.decode(frames[i], Format::bits, credential) == WiegandDecoder<Format>::Result::Ok) {
+                sink = sink + credential.tagId;
+            }
+        }
+    }
+    double elapsedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    char line[120];
+    snprintf(line, sizeof(line), "%s: %.2f ns/frame over %d frames", name,
+             elapsedNs / (static_cast<double>(rounds) * frameCount), rounds * frameCount);
+    TEST_MESSAGE(line);
+}
+
+}  // namespace
+
+void setUp(void) {
+    randomState = 0x9E3779B97F4A7C15ULL;
+}
+
+void tearDown(void) {}
+
+void test_corpus(void) {
+    checkCorpus<Wiegand26>();
+    checkCorpus<Wiegand34>();
+    checkCorpus<Wiegand37>();
+}
+
+void test_random_payloads_round_trip(void) {
+    checkRoundTrip<Wiegand26>();
+    checkRoundTrip<Wiegand34>();
+    checkRoundTrip<Wiegand37>();
+}
+
+void test_single_bit_flips_are_rejected(void) {
+    checkSingleBitFlips<Wiegand26>();
+    checkSingleBitFlips<Wiegand34>();
+    checkSingleBitFlips<Wiegand37>();
+}
+
+void test_random_frames_match_reference(void) {
+    checkRandomFramesAgainstReference<Wiegand26>();
+    checkRandomFramesAgainstReference<Wiegand34>();
+    checkRandomFramesAgainstReference<Wiegand37>();
+}
+
+void test_short_and_overlong_frames_are_rejected(void) {
+    checkShortAndOverlongFrames<Wiegand26>();
+    checkShortAndOverlongFrames<Wiegand34>();
+    checkShortAndOverlongFrames<Wiegand37>();
+}
+
+void test_facility_filter(void) {
+    checkFacilityFilter<Wiegand26>(13);
+    checkFacilityFilter<Wiegand34>(4660);
+    checkFacilityFilter<Wiegand37>(1234);
+}
+
+void test_decode_throughput(void) {
+    benchmark<Wiegand26>("Wiegand26");
+    benchmark<Wiegand34>("Wiegand34");
+    benchmark<Wiegand37>("Wiegand37");
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_corpus);
+    RUN_TEST(test_random_payloads_round_trip);
+    RUN_TEST(test_single_bit_flips_are_rejected);
+    RUN_TEST(test_random_frames_match_reference);
+    RUN_TEST(test_short_and_overlong_frames_are_rejected);
+    RUN_TEST(test_facility_filter);
+    RUN_TEST(test_decode_throughput);
+    return UNITY_END();
+}